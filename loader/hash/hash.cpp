@@ -54,4 +54,16 @@ std::string calculateSHA256Text(ghc::filesystem::path const& path) {
 
 std::string calculateHash(ghc::filesystem::path const& path) {
     return calculateSHA3_256(path);
+}
+
+void IncrementalHash::add(void const* data, size_t size) {
+    m_sha3.add(data, size);
+}
+
+void IncrementalHash::reset() {
+    m_sha3.reset();
+}
+
+std::string IncrementalHash::getHash() {
+    return m_sha3.getHash();
 }
\ No newline at end of file
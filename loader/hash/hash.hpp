@@ -2,6 +2,7 @@
 
 #include <string>
 #include <ghc/fs_fwd.hpp>
+#include "sha3.h"
 
 std::string calculateSHA3_256(ghc::filesystem::path const& path);
 
@@ -10,3 +11,16 @@ std::string calculateSHA256(ghc::filesystem::path const& path);
 std::string calculateSHA256Text(ghc::filesystem::path const& path);
 
 std::string calculateHash(ghc::filesystem::path const& path);
+
+/**
+ * Calculates the same hash as calculateHash, over data that's added in
+ * chunks as it becomes available
+ */
+class IncrementalHash {
+    SHA3 m_sha3;
+
+public:
+    void add(void const* data, size_t size);
+    void reset();
+    std::string getHash();
+};
@@ -864,7 +864,7 @@ private:
 
     [[deprecated("Will be removed, it's an ABI break")]]
     GEODE_DLL geode::modifier::FieldContainer* getFieldContainer();
-    GEODE_DLL geode::modifier::FieldContainer* getFieldContainer(char const* forClass);
+    GEODE_DLL geode::modifier::FieldContainer* getFieldContainer(size_t forClassID);
     GEODE_DLL void addEventListenerInternal(
         std::string const& id,
         geode::EventListenerProtocol* protocol
@@ -929,6 +929,15 @@ public:
      */
     GEODE_DLL CCNode* querySelector(std::string const& query);
 
+    /**
+     * Get all children matching a query. See querySelector for the supported
+     * query syntax. The tree is only walked once regardless of how many
+     * nodes match
+     * @returns The matching nodes in breadth-first order
+     * @note Geode addition
+     */
+    GEODE_DLL std::vector<CCNode*> querySelectorAll(std::string const& query);
+
     /** 
      * Removes a child from the container by its ID.
      * @param id The ID of the node
@@ -10,6 +10,10 @@ namespace geode {
     // Mod interoperability
 
     GEODE_DLL std::unordered_map<std::string, EventListenerPool*>& dispatchPools();
+    /**
+     * Get the listener pool for a dispatch ID, creating it if needed
+     */
+    GEODE_DLL EventListenerPool* getDispatchPool(std::string const& id);
 
     template <class... Args>
     class DispatchEvent : public Event {
@@ -19,21 +23,22 @@ namespace geode {
     
     public:
         DispatchEvent(std::string const& id, Args... args)
-          : m_id(id), m_args(std::make_tuple(args...)) {}
+          : m_id(id), m_args(std::move(args)...) {}
         
-        std::tuple<Args...> getArgs() const {
+        std::tuple<Args...> const& getArgs() const {
             return m_args;
         }
 
-        std::string getID() const {
+        std::string const& getID() const {
             return m_id;
         }
 
         EventListenerPool* getPool() const override {
-            if (dispatchPools().count(m_id) == 0) {
-                dispatchPools()[m_id] = new DefaultEventListenerPool();
-            }
-            return dispatchPools()[m_id];
+            return getDispatchPool(m_id);
+        }
+
+        std::optional<size_t> getFilterKey() const override {
+            return hashEventKey(m_id);
         }
     };
 
@@ -47,10 +52,11 @@ namespace geode {
         using Callback = ListenerResult(Args...);
 
         EventListenerPool* getPool() const {
-            if (dispatchPools().count(m_id) == 0) {
-                dispatchPools()[m_id] = new DefaultEventListenerPool();
-            }
-            return dispatchPools()[m_id];
+            return getDispatchPool(m_id);
+        }
+
+        std::optional<size_t> getKey() const {
+            return hashEventKey(m_id);
         }
 
         ListenerResult handle(utils::MiniFunction<Callback> fn, Ev* event) {
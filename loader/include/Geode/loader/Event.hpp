@@ -4,8 +4,13 @@
 #include "../utils/MiniFunction.hpp"
 
 #include <Geode/DefaultInclude.hpp>
+#include <optional>
+#include <string_view>
 #include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace geode {
     class Mod;
@@ -14,6 +19,33 @@ namespace geode {
 
     Mod* getMod();
 
+    /**
+     * Get the ID of an event class. IDs are handed out by the loader the
+     * first time a class is seen and are keyed by the class' name, so they
+     * are the same for every mod
+     */
+    GEODE_DLL size_t getEventTypeID(std::type_info const& type);
+
+    template <class T>
+    size_t getEventTypeID() {
+        static auto id = getEventTypeID(typeid(T));
+        return id;
+    }
+
+    /**
+     * Hash a string for use as an event filter key. Unlike std::hash this is
+     * guaranteed to give the same result in every mod
+     */
+    constexpr size_t hashEventKey(std::string_view str) {
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325;
+        for (auto c : str) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3;
+        }
+        return static_cast<size_t>(hash);
+    }
+
     enum class ListenerResult {
         Propagate,
         Stop
@@ -24,22 +56,75 @@ namespace geode {
         virtual void remove(EventListenerProtocol* listener) = 0;
         virtual ListenerResult handle(Event* event) = 0;
         virtual ~EventListenerPool() = default;
+        /**
+         * Called when the filter key of a listener in this pool changed. By
+         * default the listener is removed and added again
+         */
+        virtual void rekey(EventListenerProtocol* listener);
 
         EventListenerPool() = default;
         EventListenerPool(EventListenerPool const&) = delete;
         EventListenerPool(EventListenerPool&&) = delete;
     };
     
+    /**
+     * Checks whether an event can be handled by listeners of some event class
+     */
+    using EventTypeMatcher = bool(*)(Event*);
+
+    /**
+     * Listener pool that groups its listeners by the event class they listen
+     * for and by their filter's key, so posting an event only visits
+     * listeners that could handle it
+     */
     class GEODE_DLL DefaultEventListenerPool : public EventListenerPool {
     protected:
+        struct Entry {
+            EventListenerProtocol* listener;
+            // order of registration across the whole pool, newer listeners
+            // get priority
+            size_t order;
+        };
+        // in order of registration, so new listeners are appended and handled
+        // first by iterating from the back
+        using Entries = std::vector<Entry>;
+        struct Shard {
+            // listeners whose filter has no key
+            Entries entries;
+            // filter key -> listeners with that key
+            std::unordered_map<size_t, Entries> keyed;
+            EventTypeMatcher matcher = nullptr;
+        };
+
         std::atomic_size_t m_locked = 0;
-        std::vector<EventListenerProtocol*> m_listeners;
-        std::vector<EventListenerProtocol*> m_toAdd;
+        size_t m_nextOrder = 0;
+        // shard 0 holds listeners that don't say what they listen for and
+        // get every event. unordered_map never moves its nodes, so shards
+        // and entry lists can be referenced while new ones are being added
+        std::unordered_map<size_t, Shard> m_shards;
+        std::unordered_map<EventListenerProtocol*, Entries*> m_listenerEntries;
+        // event class -> shards whose listeners can handle it. keyed by the 
+        // class' type_info so posting doesn't have to look up its ID, which 
+        // means a class may show up more than once if its type_info isn't 
+        // unique across modules
+        std::unordered_map<std::type_info const*, std::vector<Shard*>> m_matchingShards;
+        std::unordered_set<Entries*> m_dirtyEntries;
+        // listeners whose key changed while handling an event
+        std::vector<EventListenerProtocol*> m_pendingRekeys;
+        bool m_matchingShardsStale = false;
+
+        std::vector<Shard*> const& getMatchingShards(Event* event);
+        void cleanUp();
 
     public:
         bool add(EventListenerProtocol* listener) override;
         void remove(EventListenerProtocol* listener) override;
         ListenerResult handle(Event* event) override;
+        /**
+         * Move a listener to the list for its new key, keeping its place in 
+         * the order listeners are handled in
+         */
+        void rekey(EventListenerProtocol* listener) override;
 
         static DefaultEventListenerPool* get();
     };
@@ -51,10 +136,33 @@ namespace geode {
     public:
         bool enable();
         void disable();
+        bool isEnabled() const;
+        /**
+         * Let the pool know that the listener's filter key changed
+         */
+        void updateFilterKey();
 
         virtual EventListenerPool* getPool() const;
         virtual ListenerResult handle(Event*) = 0;
         virtual ~EventListenerProtocol();
+
+        // new virtuals go after the existing ones so the vtable only grows
+
+        /**
+         * ID of the event class this listener handles, or 0 if it may handle
+         * any event
+         */
+        virtual size_t getEventTypeID() const;
+        /**
+         * Check for whether an event can be handled by this listener based on
+         * its class alone. Only called if getEventTypeID() is not 0
+         */
+        virtual EventTypeMatcher getEventTypeMatcher() const;
+        /**
+         * Key of this listener's filter, see EventFilter::getKey. Must not
+         * change while the listener is enabled
+         */
+        virtual std::optional<size_t> getFilterKey() const;
     };
 
     template <typename C, typename T>
@@ -85,6 +193,17 @@ namespace geode {
             return DefaultEventListenerPool::get();
         }
 
+        /**
+         * Filters that only ever accept events with some specific key (like
+         * a mod ID) can return a hash of it here, which lets pools only pass
+         * them events whose Event::getFilterKey matches. The key is only used
+         * for bucketing, so handle still has to check the event
+         * @returns The key, or nullopt if this filter may accept any event
+         */
+        std::optional<size_t> getKey() const {
+            return std::nullopt;
+        }
+
         void setListener(EventListenerProtocol* listener) {
             m_listener = listener;
         }
@@ -121,6 +240,20 @@ namespace geode {
             return m_filter.getPool();
         }
 
+        size_t getEventTypeID() const override {
+            return geode::getEventTypeID<typename T::Event>();
+        }
+
+        EventTypeMatcher getEventTypeMatcher() const override {
+            return +[](Event* e) {
+                return cast::typeinfo_cast<typename T::Event*>(e) != nullptr;
+            };
+        }
+
+        std::optional<size_t> getFilterKey() const override {
+            return m_filter.getKey();
+        }
+
         EventListener(T filter = T()) : m_filter(filter) {
             m_filter.setListener(this);
             this->enable();
@@ -173,10 +306,27 @@ namespace geode {
         }
 
         void setFilter(T filter) {
+            // the pool and key may depend on the filter, so re-register
+            auto pool = m_filter.getPool();
             m_filter = filter;
             m_filter.setListener(this);
+            if (!this->isEnabled()) {
+                return;
+            }
+            if (m_filter.getPool() == pool) {
+                this->updateFilterKey();
+            }
+            else {
+                this->disable();
+                this->enable();
+            }
         }
 
+        /**
+         * Listeners are grouped by their filter's key, so if a change to the
+         * filter changes its key, call updateFilterKey afterwards (or use
+         * setFilter, which does that for you)
+         */
         T& getFilter() {
             return m_filter;
         }
@@ -211,5 +361,12 @@ namespace geode {
         }
         
         virtual ~Event();
+
+        /**
+         * Key used to find the listeners whose filter key matches this
+         * event, see EventFilter::getKey
+         * @returns The key, or nullopt to pass the event to all listeners
+         */
+        virtual std::optional<size_t> getFilterKey() const;
     };
 }
@@ -115,7 +115,29 @@ namespace geode {
          * Returns the path to the specific version
          */
         ghc::filesystem::path getPath() const;
+        /**
+         * Returns the metadata of this version. The contents of its about.md 
+         * and changelog.md are only included after loadSpecialFiles
+         */
         ModMetadata getMetadata() const;
+        /**
+         * Read the about.md and changelog.md of this version into its 
+         * metadata, if they haven't been read yet
+         */
+        Result<> loadSpecialFiles();
+        /**
+         * Returns the ID of the mod. Unlike getMetadata, this and the other 
+         * getters below never have to parse the mod.json of the item
+         */
+        std::string getID() const;
+        std::string getName() const;
+        std::optional<std::string> getDescription() const;
+        std::vector<std::string> getDevelopers() const;
+        /**
+         * Returns the contents of the about.md of this version. Unlike the 
+         * details in its metadata, this doesn't need loadSpecialFiles
+         */
+        std::optional<std::string> getDetails() const;
         std::string getDownloadURL() const;
         std::string getPackageHash() const;
         std::unordered_set<PlatformID> getAvailablePlatforms() const;
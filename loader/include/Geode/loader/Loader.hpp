@@ -9,12 +9,15 @@
 #include "Types.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <matjson.hpp>
 #include <mutex>
 #include <optional>
 #include <string_view>
 
 namespace geode {
+    // stays copyable since it's part of queueInMainThread's exported 
+    // signature; queued tasks are only ever moved from there on
     using ScheduledFunction = utils::MiniFunction<void()>;
 
     struct InvalidGeodeFile {
@@ -75,6 +78,26 @@ namespace geode {
             Done
         };
 
+        /**
+         * Lane a main thread task is queued in. Input-critical tasks always 
+         * run on the next frame; normal and background tasks that don't fit 
+         * in the per-frame time budget are carried over to the following frame
+         */
+        enum class TaskPriority : uint8_t {
+            InputCritical,
+            Normal,
+            Background,
+        };
+
+        struct MainThreadQueueStats {
+            // tasks waiting to run, including the ones carried over from 
+            // previous frames
+            size_t queued;
+            // how long the last frame spent running tasks, and how many it ran
+            std::chrono::microseconds lastDrainTime;
+            size_t lastDrainCount;
+        };
+
         bool isForwardCompatMode();
 
         void saveData();
@@ -139,6 +162,13 @@ namespace geode {
         }
 
         void queueInMainThread(ScheduledFunction func);
+        void queueInMainThread(ScheduledFunction func, TaskPriority priority);
+
+        /**
+         * Get how busy the main thread queue is, for finding out whether 
+         * queued tasks are what's slowing frames down
+         */
+        MainThreadQueueStats getMainThreadQueueStats() const;
 
         friend class LoaderImpl;
 
@@ -4,6 +4,7 @@
 #include "../platform/cplatform.h"
 
 #include <Geode/DefaultInclude.hpp>
+#include <atomic>
 #include <ccTypes.h>
 #include <chrono>
 #include <ghc/fs_fwd.hpp>
@@ -80,10 +81,39 @@ namespace geode {
         using log_clock = std::chrono::system_clock;
         GEODE_DLL std::string generateLogName();
 
+        namespace impl {
+            /**
+             * The lowest severity any mod currently logs at. Read inline so 
+             * logs below it are thrown away before any of their arguments 
+             * are formatted
+             */
+            GEODE_DLL extern std::atomic<Severity::type> lowestLevel;
+        }
+
+        /**
+         * Get the lowest severity shown for mods that don't have their own 
+         * log level set. Controlled by the "log-level" setting of the loader
+         */
+        GEODE_DLL Severity getLogLevel();
+
+        /**
+         * Check whether a log of some severity from a mod would be shown
+         */
+        GEODE_DLL bool shouldLog(Severity severity, Mod* mod);
+
         GEODE_DLL void vlogImpl(Severity, Mod*, fmt::string_view format, fmt::format_args args);
 
         template <typename... Args>
         inline void logImpl(Severity severity, Mod* mod, impl::FmtStr<Args...> str, Args&&... args) {
+            // when a level is disabled for every mod, this is all it costs
+            if (severity.m_value < impl::lowestLevel.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if (!shouldLog(severity, mod)) {
+                return;
+            }
+            // arguments are only wrapped once the log is known to be shown, 
+            // since wrapping cocos objects already formats them
             [&]<typename... Ts>(Ts&&... args) {
                 vlogImpl(severity, mod, str, fmt::make_format_args(args...));
             }(impl::wrapCocosObj(args)...);
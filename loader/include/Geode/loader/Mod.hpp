@@ -17,6 +17,7 @@
 #include <tulip/TulipHook.hpp>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace geode {
@@ -41,10 +42,28 @@ namespace geode {
         UninstallWithSaveData
     };
 
+    enum class SavedValueFormat {
+        /**
+         * Saved values are stored in saved.json, which is read when the mod 
+         * is loaded and rewritten in full whenever they change
+         */
+        Json,
+        /**
+         * Saved values are stored in a binary log in saved.bin, which is only 
+         * read once the values are first used and only has the values that 
+         * changed appended to it when saving. Meant for mods with lots of 
+         * saved values
+         */
+        Binary,
+    };
+
     GEODE_HIDDEN Mod* takeNextLoaderMod();
 
     class ModImpl;
 
+    template <class T>
+    class SavedValueHandle;
+
     /**
      * Represents a Mod ingame.
      * @class Mod
@@ -117,6 +136,11 @@ namespace geode {
          */
         std::optional<VersionInfo> hasAvailableUpdate() const;
 
+        /**
+         * Write this mod's settings and saved values to disk. The files are 
+         * serialized and written on a background thread, and are always 
+         * either fully written or left as they were
+         */
         Result<> saveData();
         Result<> loadData();
 
@@ -202,7 +226,43 @@ namespace geode {
             return Loader::get()->parseLaunchArgument<T>(this->getLaunchArgumentName(name));
         }
 
+        /**
+         * Get the container of saved values. As the returned value can be 
+         * modified, this marks the saved values as changed so they are 
+         * written on the next save
+         */
         matjson::Value& getSaveContainer();
+        /**
+         * Get the container of saved values for reading
+         */
+        matjson::Value const& getSaveContainer() const;
+        /**
+         * Get a counter that changes whenever the saved values may have been 
+         * modified. The reference stays valid for as long as the mod exists
+         */
+        size_t const& getSaveContainerRevision() const;
+
+        /**
+         * Get how this mod's saved values are stored
+         */
+        SavedValueFormat getSavedValueFormat() const;
+        /**
+         * Change how this mod's saved values are stored. The values are 
+         * converted on the next save, after which the format is remembered
+         */
+        void setSavedValueFormat(SavedValueFormat format);
+        /**
+         * Write the saved values to a JSON file, regardless of their format
+         */
+        Result<> exportSavedValues(ghc::filesystem::path const& path) const;
+        /**
+         * Replace the saved values with the values in a JSON file
+         */
+        Result<> importSavedValues(ghc::filesystem::path const& path);
+        /**
+         * Get the saved data of settings. This marks the settings as changed 
+         * so they are written on the next save
+         */
         matjson::Value& getSavedSettingsData();
 
         template <class T>
@@ -227,24 +287,16 @@ namespace geode {
 
         template <class T>
         T getSavedValue(std::string_view const key) {
-            auto& saved = this->getSaveContainer();
-            if (saved.contains(key)) {
-                if (auto value = saved.try_get<T>(key)) {
-                    return *value;
-                }
-            }
-            return T();
+            return SavedValueHandle<T>::read(std::as_const(*this).getSaveContainer(), key)
+                .value_or(T());
         }
 
         template <class T>
         T getSavedValue(std::string_view const key, T const& defaultValue) {
-            auto& saved = this->getSaveContainer();
-            if (saved.contains(key)) {
-                if (auto value = saved.try_get<T>(key)) {
-                    return *value;
-                }
+            if (auto value = SavedValueHandle<T>::read(std::as_const(*this).getSaveContainer(), key)) {
+                return *value;
             }
-            saved[key] = defaultValue;
+            this->getSaveContainer()[key] = defaultValue;
             return defaultValue;
         }
 
@@ -426,12 +478,106 @@ namespace geode {
         bool isLoggingEnabled() const;
         void setLoggingEnabled(bool enabled);
 
+        /**
+         * Get the lowest severity of logs from this mod that are shown
+         */
+        Severity getLogLevel() const;
+        /**
+         * Set the lowest severity of logs from this mod that are shown
+         * @param level The level, or nullopt to use the level from the 
+         * loader's settings
+         */
+        void setLogLevel(std::optional<Severity> level);
+
         bool hasProblems() const;
         bool shouldLoad() const;
         bool isCurrentlyLoading() const;
 
         friend class ModImpl;
     };
+
+    /**
+     * Typed handle to a saved value, for reading it in hot paths. The value is 
+     * only looked up and converted from JSON again when the mod's saved 
+     * values may have changed, so reading it is usually a comparison and a 
+     * dereference. Handles may only be used on the main thread
+     */
+    template <class T>
+    class SavedValueHandle final {
+    private:
+        Mod* m_mod = nullptr;
+        std::string m_key;
+        T m_default {};
+        size_t const* m_revision = nullptr;
+        mutable size_t m_cachedRevision = 0;
+        mutable T m_value {};
+
+        void refresh() const {
+            m_value = read(std::as_const(*m_mod).getSaveContainer(), m_key).value_or(m_default);
+            m_cachedRevision = *m_revision;
+        }
+
+    public:
+        /**
+         * Read a saved value from a container of saved values
+         * @returns The value, or nullopt if it doesn't exist or has the 
+         * wrong type
+         */
+        static std::optional<T> read(matjson::Value const& saved, std::string_view const key) {
+            if (saved.contains(key)) {
+                if (auto value = saved.try_get<T>(key)) {
+                    return *value;
+                }
+            }
+            return std::nullopt;
+        }
+
+        SavedValueHandle() = default;
+
+        /**
+         * @param mod The mod whose saved value this is
+         * @param key Key of the saved value
+         * @param defaultValue Value the saved value is set to if it doesn't 
+         * exist yet
+         */
+        SavedValueHandle(Mod* mod, std::string key, T defaultValue = T()) :
+            m_mod(mod), m_key(std::move(key)), m_default(std::move(defaultValue)),
+            m_revision(&mod->getSaveContainerRevision())
+        {
+            m_value = m_mod->getSavedValue<T>(m_key, m_default);
+            m_cachedRevision = *m_revision;
+        }
+
+        explicit SavedValueHandle(std::string key, T defaultValue = T()) :
+            SavedValueHandle(Mod::get(), std::move(key), std::move(defaultValue)) {}
+
+        T const& get() const {
+            if (m_cachedRevision != *m_revision) {
+                this->refresh();
+            }
+            return m_value;
+        }
+
+        T const& operator*() const {
+            return this->get();
+        }
+
+        T const* operator->() const {
+            return &this->get();
+        }
+
+        /**
+         * Set the saved value
+         * @returns The old value
+         */
+        T set(T const& value) {
+            auto old = this->get();
+            m_mod->getSaveContainer()[m_key] = value;
+            m_value = value;
+            m_cachedRevision = *m_revision;
+            return old;
+        }
+    };
 }
 
 GEODE_HIDDEN inline char const* operator"" _spr(char const* str, size_t) {
@@ -29,6 +29,8 @@ namespace geode {
         ModStateEvent(Mod* mod, ModEventType type);
         ModEventType getType() const;
         Mod* getMod() const;
+
+        std::optional<size_t> getFilterKey() const override;
     };
 
     /**
@@ -44,6 +46,7 @@ namespace geode {
 
     public:
         ListenerResult handle(utils::MiniFunction<Callback> fn, ModStateEvent* event);
+        std::optional<size_t> getKey() const;
 
         /**
          * Create a mod state listener
@@ -4,7 +4,9 @@
 #include "Loader.hpp"
 #include "Setting.hpp"
 
+#include <memory>
 #include <optional>
+#include <string_view>
 
 namespace geode {
     struct GEODE_DLL SettingChangedEvent : public Event {
@@ -12,6 +14,8 @@ namespace geode {
         SettingValue* value;
 
         SettingChangedEvent(Mod* mod, SettingValue* value);
+
+        std::optional<size_t> getFilterKey() const override;
     };
 
     class GEODE_DLL SettingChangedFilter : public EventFilter<SettingChangedEvent> {
@@ -23,6 +27,7 @@ namespace geode {
         using Callback = void(SettingValue*);
 
         ListenerResult handle(utils::MiniFunction<Callback> fn, SettingChangedEvent* event);
+        std::optional<size_t> getKey() const;
         /**
          * Listen to changes on a setting, or all settings
          * @param modID Mod whose settings to listen to
@@ -76,4 +81,79 @@ namespace geode {
         );
         return std::monostate();
     }
+
+    /**
+     * Typed handle to a setting, for reading it in hot paths. The setting is 
+     * looked up once and its value is cached and kept up to date by listening 
+     * to SettingChangedEvent, so reading it is just a dereference
+     */
+    template <class T>
+    class SettingHandle final {
+    private:
+        struct State {
+            SettingValue* setting = nullptr;
+            T value {};
+            EventListener<SettingChangedFilter> listener;
+
+            State(SettingChangedFilter filter) : listener(std::move(filter)) {}
+        };
+        std::unique_ptr<State> m_state;
+
+    public:
+        SettingHandle() = default;
+
+        /**
+         * @param mod The mod whose setting this is
+         * @param key Key of the setting
+         */
+        SettingHandle(Mod* mod, std::string_view const key) :
+            m_state(std::make_unique<State>(SettingChangedFilter(mod->getID(), std::string(key))))
+        {
+            auto state = m_state.get();
+            // custom settings may only get registered later, in which case 
+            // the first change event provides them
+            if ((state->setting = mod->getSetting(key))) {
+                state->value = SettingValueSetter<T>::get(state->setting);
+            }
+            state->listener.bind([state](SettingValue* setting) {
+                state->setting = setting;
+                state->value = SettingValueSetter<T>::get(setting);
+            });
+        }
+
+        explicit SettingHandle(std::string_view const key) : SettingHandle(getMod(), key) {}
+
+        T const& get() const {
+            return m_state->value;
+        }
+
+        T const& operator*() const {
+            return m_state->value;
+        }
+
+        T const* operator->() const {
+            return &m_state->value;
+        }
+
+        /**
+         * Change the value of the setting
+         * @returns The old value
+         */
+        T set(T const& value) {
+            auto old = m_state->value;
+            if (m_state->setting) {
+                SettingValueSetter<T>::set(m_state->setting, value);
+                // the change event isn't posted for mods that aren't loaded
+                m_state->value = SettingValueSetter<T>::get(m_state->setting);
+            }
+            return old;
+        }
+
+        /**
+         * Whether the setting exists
+         */
+        explicit operator bool() const {
+            return m_state && m_state->setting;
+        }
+    };
 }
@@ -17,39 +17,59 @@ namespace geode {
 }
 
 namespace geode::modifier {
-    class FieldContainer {
+    /**
+     * Fields of all the modifications of one class on one node. Fields that
+     * were registered when the container was created live in one block,
+     * laid out by registerField. Fields registered afterwards (by mods
+     * loaded later) are allocated separately
+     */
+    class GEODE_DLL FieldContainer {
     private:
-        std::vector<void*> m_containedFields;
-        std::vector<utils::MiniFunction<void(void*)>> m_destructorFunctions;
+        size_t m_classID;
+        std::byte* m_block = nullptr;
+        size_t m_blockFieldCount = 0;
+        // field index -> field, or null if it hasn't been constructed yet
+        std::vector<void*> m_fields;
 
     public:
-        ~FieldContainer() {
-            for (auto i = 0u; i < m_containedFields.size(); i++) {
-                m_destructorFunctions[i](m_containedFields[i]);
-                operator delete(m_containedFields[i]);
-            }
-        }
+        explicit FieldContainer(size_t classID);
+        ~FieldContainer();
 
-        void* getField(size_t index) {
-            while (m_containedFields.size() <= index) {
-                m_containedFields.push_back(nullptr);
-                m_destructorFunctions.push_back(nullptr);
-            }
-            return m_containedFields.at(index);
-        }
+        FieldContainer(FieldContainer const&) = delete;
+        FieldContainer& operator=(FieldContainer const&) = delete;
 
-        void* setField(size_t index, size_t size, utils::MiniFunction<void(void*)> destructor) {
-            m_containedFields.at(index) = operator new(size);
-            m_destructorFunctions.at(index) = destructor;
-            return m_containedFields.at(index);
+        /**
+         * Get a field, or nullptr if it hasn't been constructed yet
+         */
+        void* getField(size_t index) const {
+            return index < m_fields.size() ? m_fields[index] : nullptr;
         }
 
-        static FieldContainer* from(cocos2d::CCNode* node, char const* forClass) {
-            return node->getFieldContainer(forClass);
+        /**
+         * Get the storage for a field and mark it as constructed. The caller
+         * is responsible for actually constructing it
+         */
+        void* setField(size_t index);
+
+        static FieldContainer* from(cocos2d::CCNode* node, size_t classID) {
+            return node->getFieldContainer(classID);
         }
     };
 
-    GEODE_DLL size_t getFieldIndexForClass(char const* name);
+    struct FieldRegistration {
+        // dense ID of the modified class, shared by all mods
+        size_t classID;
+        // index of the field in the class' field containers
+        size_t index;
+    };
+
+    /**
+     * Register the fields of a modification. The IDs are global across all 
+     * mods, so the function is defined in the loader source
+     */
+    GEODE_DLL FieldRegistration registerField(
+        char const* forClass, size_t size, size_t alignment, void (*destructor)(void*)
+    );
 
     template <class Parent>
     concept HasFields = requires {
@@ -104,6 +124,30 @@ namespace geode::modifier {
             }
         }
 
+        static constexpr size_t fieldSize() {
+            if constexpr (HasFields<Parent>) {
+                return sizeof(typename Parent::Fields);
+            }
+            else {
+                return sizeof(Parent) - sizeof(Intermediate);
+            }
+        }
+
+        static constexpr size_t fieldAlignment() {
+            if constexpr (HasFields<Parent>) {
+                return alignof(typename Parent::Fields);
+            }
+            else {
+                return alignof(Parent);
+            }
+        }
+
+        // registered during static init so every modification of a class 
+        // knows where its fields are before any node is created
+        static inline FieldRegistration const s_registration = registerField(
+            typeid(Base).name(), fieldSize(), fieldAlignment(), &FieldIntermediate::fieldDestructor
+        );
+
         [[deprecated("Fields are now done using an explicit `Fields` struct. Please refer to https://docs.geode-sdk.org/tutorials/fields/ for more information.")]]
         auto deprecatedSelf() {
             // get the this pointer of the base
@@ -113,19 +157,13 @@ namespace geode::modifier {
             static_assert(sizeof(Base) == offsetof(Parent, m_fields), "offsetof not correct");
 
             // generating the container if it doesn't exist
-            auto container = FieldContainer::from(node, typeid(Base).name());
-
-            // the index is global across all mods, so the
-            // function is defined in the loader source
-            static size_t index = getFieldIndexForClass(typeid(Base).name());
+            auto container = FieldContainer::from(node, s_registration.classID);
 
             // the fields are actually offset from their original
             // offset, this is done to save on allocation and space
-            auto offsetField = container->getField(index);
+            auto offsetField = container->getField(s_registration.index);
             if (!offsetField) {
-                offsetField = container->setField(
-                    index, sizeof(Parent) - sizeof(Intermediate), &FieldIntermediate::fieldDestructor
-                );
+                offsetField = container->setField(s_registration.index);
 
                 FieldIntermediate::fieldConstructor(offsetField);
             }
@@ -144,19 +182,11 @@ namespace geode::modifier {
                 static_assert(sizeof(Base) == offsetof(Parent, m_fields), "offsetof not correct");
 
                 // generating the container if it doesn't exist
-                auto container = FieldContainer::from(node, typeid(Base).name());
-
-                // the index is global across all mods, so the
-                // function is defined in the loader source
-                static size_t index = getFieldIndexForClass(typeid(Base).name());
+                auto container = FieldContainer::from(node, s_registration.classID);
 
-                // the fields are actually offset from their original
-                // offset, this is done to save on allocation and space
-                auto offsetField = container->getField(index);
+                auto offsetField = container->getField(s_registration.index);
                 if (!offsetField) {
-                    offsetField = container->setField(
-                        index, sizeof(typename Parent::Fields), &FieldIntermediate::fieldDestructor
-                    );
+                    offsetField = container->setField(s_registration.index);
 
                     FieldIntermediate::fieldConstructor(offsetField);
                 }
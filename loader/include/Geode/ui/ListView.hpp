@@ -3,6 +3,9 @@
 #include <Geode/binding/CustomListView.hpp>
 #include <Geode/binding/CCIndexPath.hpp>
 #include <Geode/binding/TableViewCell.hpp>
+#include <Geode/utils/cocos.hpp>
+#include <deque>
+#include <vector>
 
 namespace geode {
     class GEODE_DLL GenericListCell : public TableViewCell {
@@ -17,6 +20,34 @@ namespace geode {
         void updateBGColor(int index);
     };
 
+    /**
+     * Provides the cells of a ListView as they scroll into view, so the
+     * list doesn't have to create a node for every item up front
+     */
+    class GEODE_DLL ListViewDataSource {
+    public:
+        virtual ~ListViewDataSource() = default;
+
+        /**
+         * Get the amount of cells in the list
+         */
+        virtual size_t getCellCount() = 0;
+        /**
+         * Get the height of every cell in the list
+         */
+        virtual float getCellHeight() = 0;
+        /**
+         * Get the node to show for a cell that scrolled into view
+         * @param reuse A node that was shown for a cell that has since
+         * scrolled out of view, or nullptr if there is none. If the node was
+         * last shown for the same cell, it's passed again before any other.
+         * Return it to reuse it, or a new node if it can't be reused
+         * @param index Index of the cell
+         * @returns The node to show for the cell
+         */
+        virtual cocos2d::CCNode* bindCell(cocos2d::CCNode* reuse, size_t index) = 0;
+    };
+
     /**
      * Class for a generic scrollable list of
      * items like the level list in GD
@@ -43,4 +74,59 @@ namespace geode {
             float height = 220.f
         );
     };
+
+    /**
+     * A ListView that only has nodes for the items that are in view. Kept 
+     * separate so ListView itself stays the same size
+     */
+    class GEODE_DLL RecyclingListView : public ListView {
+    protected:
+        ListViewDataSource* m_dataSource = nullptr;
+        // rows of the list by cell index
+        std::vector<GenericListCell*> m_rows;
+        // nodes bound to rows that are currently in view
+        std::vector<cocos2d::CCNode*> m_bound;
+        // nodes that scrolled out of view along with the cell they last 
+        // showed, oldest first
+        std::deque<std::pair<size_t, Ref<cocos2d::CCNode>>> m_pool;
+        float m_lastScroll = 0.f;
+
+        void setupList(float) override;
+        void loadCell(TableViewCell* cell, int index) override;
+
+        bool isRowVisible(size_t index) const;
+        void bindCell(size_t index);
+        void unbindCell(size_t index);
+        void checkVisibleCells(float);
+
+    public:
+        /**
+         * Create a scrollable list that only has nodes for the items that
+         * are in view. Nodes are requested from the data source as items
+         * scroll into view, and recycled once they scroll out of it
+         * @param dataSource Provides the nodes of the list. Must outlive
+         * the list
+         * @param width Width of the list
+         * @param height Height of the list
+         * @returns The created list, or nullptr
+         * on error
+         */
+        static RecyclingListView* create(
+            ListViewDataSource* dataSource, float width = 358.f, float height = 220.f
+        );
+
+        /**
+         * Bind and unbind the nodes of the list according to what's in 
+         * view. This is done every frame, but may be called after moving 
+         * the list to update it right away
+         */
+        void updateVisibleCells();
+
+        /**
+         * Get the node shown for a cell, if it's in view
+         * @param index Index of the cell
+         * @returns The node, or nullptr if the cell isn't bound to one
+         */
+        cocos2d::CCNode* getBoundCell(size_t index) const;
+    };
 }
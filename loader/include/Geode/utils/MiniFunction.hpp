@@ -1,135 +1,246 @@
 #pragma once
 
 #include <Geode/DefaultInclude.hpp>
-#include <memory>
 #include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace geode::utils {
 
+    template <class FunctionType, bool Copyable>
+    class BasicMiniFunction;
+
+    /**
+     * Lightweight std::function alternative. Small callables (captureless
+     * lambdas, function pointers, lambdas capturing a few pointers) are
+     * stored inline without allocating
+     */
+    template <class FunctionType>
+    using MiniFunction = BasicMiniFunction<FunctionType, true>;
+
+    /**
+     * MiniFunction that can only be moved, which lets it hold callables that
+     * can't be copied and guarantees it is never deep-copied by accident
+     */
     template <class FunctionType>
-    class MiniFunction;
+    using MoveOnlyMiniFunction = BasicMiniFunction<FunctionType, false>;
+
+    /**
+     * Callables up to this size are stored inside the MiniFunction itself.
+     * MiniFunctions are passed between mods and the loader, so changing this
+     * requires raising the loader's minimum mod version
+     */
+    inline constexpr size_t MINI_FUNCTION_INLINE_SIZE = 32;
+
+    template <class Type>
+    inline constexpr bool MINI_FUNCTION_STORED_INLINE =
+        sizeof(Type) <= MINI_FUNCTION_INLINE_SIZE &&
+        alignof(Type) <= alignof(void*) &&
+        std::is_nothrow_move_constructible_v<Type>;
+
+    /**
+     * How arguments are passed on to the callable. Arguments taken by value
+     * are passed as lvalues since callables may take them by reference,
+     * rvalue references stay rvalues so callables can move from them
+     */
+    template <class Arg>
+    using MiniFunctionArg = std::conditional_t<std::is_rvalue_reference_v<Arg>, Arg, Arg&>;
 
     template <class Ret, class... Args>
-    class MiniFunctionStateBase {
-    public:
-        virtual ~MiniFunctionStateBase() = default;
-        virtual Ret call(Args... args) const = 0;
-        virtual MiniFunctionStateBase* clone() const = 0;
+    struct MiniFunctionVTable {
+        Ret (*call)(void const* storage, Args... args);
+        // only ever called by copyable MiniFunctions
+        void (*copy)(void* dst, void const* src);
+        // move-constructs dst from src and destroys src
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void* storage);
     };
 
     template <class Type, class Ret, class... Args>
-    class MiniFunctionState final : public MiniFunctionStateBase<Ret, Args...> {
-    public:
-        Type m_func;
-
-        explicit MiniFunctionState(Type func) : m_func(func) {}
-
-        Ret call(Args... args) const override {
-            return const_cast<Type&>(m_func)(args...);
+    struct MiniFunctionOps {
+        static constexpr bool STORED_INLINE = MINI_FUNCTION_STORED_INLINE<Type>;
+
+        static Type* get(void const* storage) {
+            if constexpr (STORED_INLINE) {
+                return std::launder(reinterpret_cast<Type*>(const_cast<void*>(storage)));
+            }
+            else {
+                return *reinterpret_cast<Type* const*>(storage);
+            }
         }
 
-        MiniFunctionStateBase<Ret, Args...>* clone() const override {
-            return new MiniFunctionState(*this);
+        template <class Callable>
+        static void create(void* storage, Callable&& func) {
+            if constexpr (STORED_INLINE) {
+                new (storage) Type(std::forward<Callable>(func));
+            }
+            else {
+                *reinterpret_cast<Type**>(storage) = new Type(std::forward<Callable>(func));
+            }
         }
-    };
-
-    template <class Type, class Ret, class... Args>
-    class MiniFunctionStatePointer final : public MiniFunctionStateBase<Ret, Args...> {
-    public:
-        Type m_func;
-
-        explicit MiniFunctionStatePointer(Type func) : m_func(func) {}
 
-        Ret call(Args... args) const override {
-            return const_cast<Type&>(*m_func)(args...);
+        static Ret call(void const* storage, Args... args) {
+            // mutable lambdas are allowed to change their captures
+            return std::invoke(*get(storage), static_cast<MiniFunctionArg<Args>>(args)...);
         }
 
-        MiniFunctionStateBase<Ret, Args...>* clone() const override {
-            return new MiniFunctionStatePointer(*this);
+        static void copy(void* dst, void const* src) {
+            if constexpr (std::is_copy_constructible_v<Type>) {
+                create(dst, *get(src));
+            }
         }
-    };
 
-    template <class Type, class Ret, class Class, class... Args>
-    class MiniFunctionStateMemberPointer final : public MiniFunctionStateBase<Ret, Class, Args...> {
-    public:
-        Type m_func;
-
-        explicit MiniFunctionStateMemberPointer(Type func) : m_func(func) {}
-
-        Ret call(Class self, Args... args) const override {
-            return const_cast<Type&>(self->*m_func)(args...);
+        static void move(void* dst, void* src) {
+            if constexpr (STORED_INLINE) {
+                auto func = get(src);
+                new (dst) Type(std::move(*func));
+                func->~Type();
+            }
+            else {
+                *reinterpret_cast<Type**>(dst) = get(src);
+            }
         }
 
-        MiniFunctionStateBase<Ret, Class, Args...>* clone() const override {
-            return new MiniFunctionStateMemberPointer(*this);
+        static void destroy(void* storage) {
+            if constexpr (STORED_INLINE) {
+                get(storage)->~Type();
+            }
+            else {
+                delete get(storage);
+            }
         }
+
+        static constexpr MiniFunctionVTable<Ret, Args...> VTABLE = {
+            &call, &copy, &move, &destroy
+        };
     };
-    
+
     template <class Callable, class Ret, class... Args>
-    concept MiniFunctionCallable = requires(Callable&& func, Args... args) {
-        { func(args...) } -> std::same_as<Ret>;
+    concept MiniFunctionCallable = requires(Callable&& func) {
+        { func(std::declval<MiniFunctionArg<Args>>()...) } -> std::same_as<Ret>;
     };
 
-    template <class Ret, class... Args>
-    class MiniFunction<Ret(Args...)> {
+    template <class Ret, class... Args, bool Copyable>
+    class BasicMiniFunction<Ret(Args...), Copyable> {
     public:
         using FunctionType = Ret(Args...);
-        using StateType = MiniFunctionStateBase<Ret, Args...>;
+        using VTableType = MiniFunctionVTable<Ret, Args...>;
 
     private:
-        StateType* m_state;
+        template <class, bool>
+        friend class BasicMiniFunction;
+
+        template <class Type>
+        static constexpr bool IS_MINI_FUNCTION =
+            std::is_same_v<Type, BasicMiniFunction<FunctionType, true>> ||
+            std::is_same_v<Type, BasicMiniFunction<FunctionType, false>>;
+
+        VTableType const* m_vtable = nullptr;
+        alignas(void*) std::byte m_storage[MINI_FUNCTION_INLINE_SIZE];
+
+        template <class Type, class Callable>
+        void emplace(Callable&& func) {
+            if constexpr (Copyable) {
+                static_assert(
+                    std::is_copy_constructible_v<Type>,
+                    "MiniFunction requires a copyable callable, use MoveOnlyMiniFunction instead"
+                );
+            }
+            using Ops = MiniFunctionOps<Type, Ret, Args...>;
+            Ops::create(m_storage, std::forward<Callable>(func));
+            m_vtable = &Ops::VTABLE;
+        }
+
+        void reset() {
+            if (m_vtable) {
+                m_vtable->destroy(m_storage);
+                m_vtable = nullptr;
+            }
+        }
+
+        template <bool OtherCopyable>
+        void moveFrom(BasicMiniFunction<FunctionType, OtherCopyable>& other) {
+            if (other.m_vtable) {
+                other.m_vtable->move(m_storage, other.m_storage);
+                m_vtable = std::exchange(other.m_vtable, nullptr);
+            }
+        }
 
     public:
-        MiniFunction() : m_state(nullptr) {}
+        BasicMiniFunction() = default;
 
-        MiniFunction(std::nullptr_t) : MiniFunction() {}
+        BasicMiniFunction(std::nullptr_t) : BasicMiniFunction() {}
+
+        BasicMiniFunction(BasicMiniFunction const& other) requires(Copyable) {
+            if (other.m_vtable) {
+                other.m_vtable->copy(m_storage, other.m_storage);
+                m_vtable = other.m_vtable;
+            }
+        }
 
-        MiniFunction(MiniFunction const& other) :
-            m_state(other.m_state ? other.m_state->clone() : nullptr) {}
+        BasicMiniFunction(BasicMiniFunction&& other) noexcept {
+            this->moveFrom(other);
+        }
 
-        MiniFunction(MiniFunction&& other) : m_state(other.m_state) {
-            other.m_state = nullptr;
+        /**
+         * Take the callable of a copyable MiniFunction without wrapping it
+         */
+        BasicMiniFunction(BasicMiniFunction<FunctionType, true>&& other) noexcept requires(!Copyable) {
+            this->moveFrom(other);
         }
 
-        ~MiniFunction() {
-            delete m_state;
+        ~BasicMiniFunction() {
+            this->reset();
         }
 
         template <class Callable>
-        requires(MiniFunctionCallable<Callable, Ret, Args...> && !std::is_same_v<std::decay_t<Callable>, MiniFunction<FunctionType>>)
-        MiniFunction(Callable&& func) :
-            m_state(new MiniFunctionState<std::decay_t<Callable>, Ret, Args...>(std::forward<Callable>(func))) {}
+        requires(MiniFunctionCallable<Callable, Ret, Args...> && !IS_MINI_FUNCTION<std::decay_t<Callable>>)
+        BasicMiniFunction(Callable&& func) {
+            this->emplace<std::decay_t<Callable>>(std::forward<Callable>(func));
+        }
 
-        template <class FunctionPointer> 
+        template <class FunctionPointer>
         requires(!MiniFunctionCallable<FunctionPointer, Ret, Args...> && std::is_pointer_v<FunctionPointer> && std::is_function_v<std::remove_pointer_t<FunctionPointer>>)
-        MiniFunction(FunctionPointer func) :
-            m_state(new MiniFunctionStatePointer<FunctionPointer, Ret, Args...>(func)) {}
+        BasicMiniFunction(FunctionPointer func) {
+            this->emplace<FunctionPointer>(func);
+        }
 
-        template <class MemberFunctionPointer> 
+        template <class MemberFunctionPointer>
         requires(std::is_member_function_pointer_v<MemberFunctionPointer>)
-        MiniFunction(MemberFunctionPointer func) :
-            m_state(new MiniFunctionStateMemberPointer<MemberFunctionPointer, Ret, Args...>(func)) {}
+        BasicMiniFunction(MemberFunctionPointer func) {
+            this->emplace<MemberFunctionPointer>(func);
+        }
 
-        MiniFunction& operator=(MiniFunction const& other) {
-            delete m_state;
-            m_state = other.m_state ? other.m_state->clone() : nullptr;
+        BasicMiniFunction& operator=(BasicMiniFunction const& other) requires(Copyable) {
+            if (this != &other) {
+                this->reset();
+                if (other.m_vtable) {
+                    other.m_vtable->copy(m_storage, other.m_storage);
+                    m_vtable = other.m_vtable;
+                }
+            }
             return *this;
         }
 
-        MiniFunction& operator=(MiniFunction&& other) {
-            delete m_state;
-            m_state = other.m_state;
-            other.m_state = nullptr;
+        BasicMiniFunction& operator=(BasicMiniFunction&& other) noexcept {
+            if (this != &other) {
+                this->reset();
+                this->moveFrom(other);
+            }
             return *this;
         }
 
         Ret operator()(Args... args) const {
-            if (!m_state) return Ret();
-            return m_state->call(args...);
+            if (!m_vtable) return Ret();
+            return m_vtable->call(m_storage, std::forward<Args>(args)...);
         }
 
         explicit operator bool() const {
-            return m_state;
+            return m_vtable;
         }
     };
 }
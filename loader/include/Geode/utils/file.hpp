@@ -40,6 +40,13 @@ namespace geode::utils::file {
     GEODE_DLL Result<> writeString(ghc::filesystem::path const& path, std::string const& data);
     GEODE_DLL Result<> writeBinary(ghc::filesystem::path const& path, ByteVector const& data);
 
+    /**
+     * Write a string to a file so that it has either its old or its new 
+     * contents if the game crashes midway. The data is written to a 
+     * temporary file and flushed to disk first, which then replaces the file
+     */
+    GEODE_DLL Result<> writeStringSafe(ghc::filesystem::path const& path, std::string const& data);
+
     template <class T>
     Result<> writeToJson(ghc::filesystem::path const& path, T const& data) {
         GEODE_UNWRAP(writeString(path, matjson::Value(data).dump()));
@@ -197,6 +204,27 @@ namespace geode::utils::file {
          * @param dir Directory to unzip the contents to
          */
         Result<> extractAllTo(Path const& dir);
+        /**
+         * Extract all entries to directory, skipping the ones that haven't 
+         * changed since the last time this zip was extracted there. Entries 
+         * are compared by their CRC32 and size, which are stored in a manifest 
+         * file in the directory. Files that were in the previous manifest but 
+         * are no longer in the zip are deleted
+         * @param dir Directory to unzip the contents to
+         */
+        Result<> extractChangedTo(Path const& dir);
+        /**
+         * Replace a directory extracted from another version of this zip 
+         * with the contents of this one. The new contents are put together 
+         * in a staging directory next to it, reusing the files that haven't 
+         * changed according to the manifest written by the last update, and 
+         * only swapped in once everything has been extracted
+         * @param dir Directory to update
+         * @param root Directory in the zip to extract the contents of, for 
+         * zips that have everything in a single folder. Empty to extract the 
+         * whole zip
+         */
+        Result<> updateDirectory(Path const& dir, Path const& root = Path());
 
         /**
          * Helper method for quickly unzipping a file
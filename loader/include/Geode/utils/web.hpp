@@ -15,14 +15,18 @@ namespace geode::utils::web {
     using FileProgressCallback = utils::MiniFunction<bool(double, double)>;
 
     /**
-     * Synchronously fetch data from the internet
+     * Synchronously fetch data from the internet. The transfer runs on the 
+     * calling thread, which is blocked until it's done; it doesn't wait 
+     * behind queued async requests
      * @param url URL to fetch
      * @returns Returned data as bytes, or error on error
      */
     GEODE_DLL Result<ByteVector> fetchBytes(std::string const& url);
 
     /**
-     * Synchronously fetch data from the internet
+     * Synchronously fetch data from the internet. The transfer runs on the 
+     * calling thread, which is blocked until it's done; it doesn't wait 
+     * behind queued async requests
      * @param url URL to fetch
      * @returns Returned data as string, or error on error
      */
@@ -35,7 +39,8 @@ namespace geode::utils::web {
      * @param prog Progress function; first parameter is bytes downloaded so
      * far, and second is total bytes to download. Return true to continue
      * downloading, and false to interrupt. Note that interrupting does not
-     * automatically remove the file that was being downloaded
+     * automatically remove the file that was being downloaded. The 
+     * transfer runs on the calling thread, which is blocked until it's done
      * @returns Returned data as JSON, or error on error
      */
     GEODE_DLL Result<> fetchFile(
@@ -58,8 +63,10 @@ namespace geode::utils::web {
     using AsyncProgress = utils::MiniFunction<void(SentAsyncWebRequest&, double, double)>;
     using AsyncExpect = utils::MiniFunction<void(std::string const&)>;
     using AsyncExpectCode = utils::MiniFunction<void(std::string const&, int)>;
-    using AsyncThen = utils::MiniFunction<void(SentAsyncWebRequest&, ByteVector const&)>;
+    // callbacks taking the data by const reference still work
+    using AsyncThen = utils::MiniFunction<void(SentAsyncWebRequest&, ByteVector&&)>;
     using AsyncCancelled = utils::MiniFunction<void(SentAsyncWebRequest&)>;
+    using AsyncReceived = utils::MiniFunction<void(uint8_t const* data, size_t size, size_t offset)>;
 
     /**
      * A handle to an in-progress sent asynchronous web request. Use this to
@@ -74,8 +81,6 @@ namespace geode::utils::web {
         friend class AsyncWebResult;
         friend class AsyncWebRequest;
 
-        void pause();
-        void resume();
         void error(std::string const& error, int code);
         void doCancel();
 
@@ -106,8 +111,36 @@ namespace geode::utils::web {
 
     using SentAsyncWebRequestHandle = std::shared_ptr<SentAsyncWebRequest>;
 
+    /**
+     * How a request uses the on-disk cache of web responses. Only GET
+     * requests downloaded into memory are cached
+     */
+    enum class CachePolicy {
+        /**
+         * Always download the response and don't store it
+         */
+        None,
+        /**
+         * Store the response. Later requests ask the server whether the
+         * stored response is still current, and only download it again if
+         * it isn't
+         */
+        Revalidate,
+        /**
+         * Like Revalidate, but the stored response is used without asking 
+         * the server for as long as the server said it stays current
+         */
+        PreferCache,
+    };
+
     template <class T>
     using DataConverter = Result<T> (*)(ByteVector const&);
+    /**
+     * Like DataConverter, but takes ownership of the downloaded data so it
+     * doesn't have to be copied
+     */
+    template <class T>
+    using OwningDataConverter = Result<T> (*)(ByteVector&&);
 
     /**
      * An asynchronous, thread-safe web request. Downloads data from the
@@ -225,6 +258,12 @@ namespace geode::utils::web {
          * Specify a timeout, in seconds, in which the request will fail.
          */
         AsyncWebRequest& timeout(std::chrono::seconds seconds);
+        /**
+         * Specify whether the response should be stored and reused by later
+         * requests to the same URL. Responses are only stored if the server
+         * allows it. Meant for data that's fetched often but rarely changes
+         */
+        AsyncWebRequest& cache(CachePolicy policy);
 
         // Callbacks
 
@@ -259,15 +298,31 @@ namespace geode::utils::web {
          * @returns Same AsyncWebRequest
          */
         AsyncWebRequest& cancelled(AsyncCancelled handler);
+        /**
+         * Specify a callback to run for every chunk of data as it's
+         * downloaded, for example to hash it without reading it back
+         * afterwards. Unlike the other callbacks, this runs on the network
+         * thread, so keep it short. When resuming a download, it's first
+         * called with the data that was downloaded earlier. An offset of 0
+         * means the download started over from the beginning
+         * @param handler Callback to run with each chunk, its size and its
+         * offset from the start of the response
+         * @returns Same AsyncWebRequest
+         */
+        AsyncWebRequest& received(AsyncReceived handler);
     };
 
     template <class T>
     class AsyncWebResult {
     private:
         AsyncWebRequest& m_request;
-        DataConverter<T> m_converter;
+        utils::MiniFunction<Result<T>(ByteVector&&)> m_converter;
 
         AsyncWebResult(AsyncWebRequest& request, DataConverter<T> converter) :
+            m_request(request), m_converter([converter](ByteVector&& data) {
+                return converter(data);
+            }) {}
+        AsyncWebResult(AsyncWebRequest& request, OwningDataConverter<T> converter) :
             m_request(request), m_converter(converter) {}
 
         friend class AsyncWebResponse;
@@ -322,6 +377,17 @@ namespace geode::utils::web {
          * into `into`
          */
         AsyncWebResult<std::monostate> into(ghc::filesystem::path const& path);
+        /**
+         * Download into a file, continuing an earlier download into it that
+         * didn't finish. Only the rest of the file is requested, and if the
+         * server doesn't support that, the file is downloaded from the start.
+         * The file is kept if the download fails so it can be resumed later,
+         * but removed if the download is cancelled
+         * @param path File to download into
+         * @returns AsyncWebResult, where you can specify the `then` action for
+         * after the download is finished
+         */
+        AsyncWebResult<std::monostate> resumeInto(ghc::filesystem::path const& path);
         /**
          * Download into memory as a string
          * @returns AsyncWebResult, where you can specify the `then` action for
@@ -359,10 +425,10 @@ namespace geode::utils::web {
     template <class T>
     AsyncWebRequest& AsyncWebResult<T>::then(utils::MiniFunction<void(T)> handle) {
         return m_request.setThen([converter = m_converter,
-                            handle](SentAsyncWebRequest& req, ByteVector const& arr) {
-            auto conv = converter(arr);
+                            handle](SentAsyncWebRequest& req, ByteVector&& arr) {
+            auto conv = converter(std::move(arr));
             if (conv) {
-                handle(conv.unwrap());
+                handle(std::move(conv.unwrap()));
             }
             else {
                 req.error("Unable to convert value: " + conv.unwrapErr(), -1);
@@ -373,10 +439,10 @@ namespace geode::utils::web {
     template <class T>
     AsyncWebRequest& AsyncWebResult<T>::then(utils::MiniFunction<void(SentAsyncWebRequest&, T)> handle) {
         return m_request.setThen([converter = m_converter,
-                            handle](SentAsyncWebRequest& req, ByteVector const& arr) {
-            auto conv = converter(arr);
+                            handle](SentAsyncWebRequest& req, ByteVector&& arr) {
+            auto conv = converter(std::move(arr));
             if (conv) {
-                handle(req, conv.value());
+                handle(req, std::move(conv.value()));
             }
             else {
                 req.error("Unable to convert value: " + conv.error(), -1);
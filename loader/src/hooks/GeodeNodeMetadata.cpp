@@ -3,7 +3,10 @@
 #include <Geode/modify/Field.hpp>
 #include <Geode/modify/CCNode.hpp>
 #include <cocos2d.h>
+#include <algorithm>
+#include <new>
 #include <queue>
+#include <utility>
 
 using namespace geode::prelude;
 using namespace geode::modifier;
@@ -15,11 +18,80 @@ constexpr auto METADATA_TAG = 0xB324ABC;
 
 struct ProxyCCNode;
 
+// node IDs are interned so they can be compared and hashed by pointer. the 
+// set never shrinks, but the amount of distinct IDs in the game is small
+using NodeID = std::string const*;
+
+// nodes in the ID indices aren't retained, so they're stored along with 
+// where they were in their parent's children. a hit is only used if the 
+// same pointer is still at that position, which makes it safe to access
+struct IndexedChild {
+    CCNode* node;
+    unsigned int index;
+};
+struct IndexedDescendant {
+    CCNode* node;
+    // index in the children of each node on the way down
+    std::vector<unsigned int> path;
+};
+using NodeIDIndex = std::unordered_map<NodeID, IndexedChild>;
+using NodeIDSubtreeIndex = std::unordered_map<NodeID, IndexedDescendant>;
+
+// bumped whenever the children of any node change through the hooked 
+// functions, so subtree indices can tell if they're out of date
+static unsigned int s_nodeTreeGeneration = 0;
+
+static std::unordered_set<std::string>& getNodeIDs() {
+    static std::unordered_set<std::string> ids;
+    return ids;
+}
+
+static NodeID internNodeID(std::string const& id) {
+    if (id.empty()) {
+        return nullptr;
+    }
+    return &*getNodeIDs().insert(id).first;
+}
+
+// returns null if no node has ever had this ID
+static NodeID findNodeID(std::string const& id) {
+    auto& ids = getNodeIDs();
+    auto it = ids.find(id);
+    return it != ids.end() ? &*it : nullptr;
+}
+
+static CCNode* getChildAt(CCNode* parent, unsigned int index) {
+    auto children = parent->getChildren();
+    if (!children || index >= children->count()) {
+        return nullptr;
+    }
+    return static_cast<CCNode*>(children->objectAtIndex(index));
+}
+
 class GeodeNodeMetadata final : public cocos2d::CCObject {
 private:
-    FieldContainer* m_fieldContainer;
-    std::unordered_map<std::string, FieldContainer*> m_classFieldContainers;
-    std::string m_id = "";
+    FieldContainer* m_fieldContainer = nullptr;
+    // nodes usually only have fields for one or two classes, so a linear
+    // search beats hashing
+    std::vector<std::pair<size_t, FieldContainer*>> m_classFieldContainers;
+    NodeID m_id = nullptr;
+    // bumped whenever the children of this node or their IDs change
+    unsigned int m_childGeneration = 0;
+    // ID -> first child with that ID, built when needed
+    NodeIDIndex m_childIndex;
+    bool m_childIndexValid = false;
+    unsigned int m_childIndexGeneration = 0;
+    // when the child index was built and how many children there were, to 
+    // tell whether a miss can be trusted
+    unsigned int m_childIndexFrame = 0;
+    unsigned int m_childIndexCount = 0;
+    // ID -> node getChildByIDRecursive would find, built when needed
+    NodeIDSubtreeIndex m_subtreeIndex;
+    bool m_subtreeIndexValid = false;
+    unsigned int m_subtreeIndexGeneration = 0;
+    unsigned int m_subtreeIndexFrame = 0;
+    // tree generation at the last recursive lookup
+    unsigned int m_subtreeLookupGeneration = 0;
     Ref<Layout> m_layout = nullptr;
     Ref<LayoutOptions> m_layoutOptions = nullptr;
     std::unordered_map<std::string, Ref<CCObject>> m_userObjects;
@@ -29,7 +101,7 @@ private:
     friend class ProxyCCNode;
     friend class cocos2d::CCNode;
 
-    GeodeNodeMetadata() : m_fieldContainer(new FieldContainer()) {}
+    GeodeNodeMetadata() {}
 
     virtual ~GeodeNodeMetadata() {
         delete m_fieldContainer;
@@ -64,15 +136,213 @@ public:
         return meta;
     }
 
+    /**
+     * Get the metadata of a node without creating it if it doesn't exist
+     */
+    static GeodeNodeMetadata* get(CCNode* target) {
+        if (!target) return nullptr;
+        auto obj = target->m_pUserObject;
+        if (obj && obj->getTag() == METADATA_TAG) {
+            return static_cast<GeodeNodeMetadata*>(obj);
+        }
+        return nullptr;
+    }
+
+    static NodeID getNodeID(CCNode* node) {
+        auto meta = GeodeNodeMetadata::get(node);
+        return meta ? meta->m_id : nullptr;
+    }
+
+    /**
+     * Call when the children of a node or their IDs have changed. The 
+     * indices check this when they're used, so this is cheap enough to call 
+     * every time a child is added
+     */
+    static void markChildrenChanged(CCNode* node) {
+        if (auto meta = GeodeNodeMetadata::get(node)) {
+            meta->m_childGeneration += 1;
+        }
+        s_nodeTreeGeneration += 1;
+    }
+
+    static unsigned int getCurrentFrame() {
+        return CCDirector::sharedDirector()->getTotalFrames();
+    }
+
+    CCNode* findChild(CCNode* self, NodeID id) {
+        auto& index = this->getChildIndex(self);
+        auto it = index.find(id);
+        if (it == index.end()) {
+            // the game can also add children without going through the 
+            // hooked functions, so a miss is confirmed by rebuilding the 
+            // index. that's only done once a frame unless the amount of 
+            // children changed, so repeated misses stay cheap
+            if (
+                m_childIndexFrame == getCurrentFrame() &&
+                m_childIndexCount == self->getChildrenCount()
+            ) {
+                return nullptr;
+            }
+            m_childIndexValid = false;
+            return this->findIndexedChild(self, id);
+        }
+        // the game can also remove or shuffle children without going through 
+        // the hooked functions, so make sure the result is still correct
+        if (!this->isValidChild(self, id, it->second)) {
+            m_childIndexValid = false;
+            return this->findIndexedChild(self, id);
+        }
+        return it->second.node;
+    }
+
+    CCNode* findDescendant(CCNode* self, NodeID id) {
+        // while the tree is being built, rebuilding the index for every 
+        // lookup would be slower than searching, so it's only built once 
+        // there are two lookups in a row without anything changing
+        auto lastLookup = std::exchange(m_subtreeLookupGeneration, s_nodeTreeGeneration);
+        if (
+            (!m_subtreeIndexValid || m_subtreeIndexGeneration != s_nodeTreeGeneration) &&
+            lastLookup != s_nodeTreeGeneration
+        ) {
+            return GeodeNodeMetadata::searchDescendant(self, id);
+        }
+        auto& index = this->getSubtreeIndex(self);
+        auto it = index.find(id);
+        if (it == index.end()) {
+            // same as for children, but counting the whole subtree would 
+            // cost as much as rebuilding it
+            if (m_subtreeIndexFrame == getCurrentFrame()) {
+                return nullptr;
+            }
+            m_subtreeIndexValid = false;
+            return this->findIndexedDescendant(self, id);
+        }
+        if (!this->isValidDescendant(self, id, it->second)) {
+            m_subtreeIndexValid = false;
+            return this->findIndexedDescendant(self, id);
+        }
+        return it->second.node;
+    }
+
+    // the pointer is only followed if it's still among the children, since 
+    // the node may have been freed since the index was built
+    static bool isValidChild(CCNode* self, NodeID id, IndexedChild const& entry) {
+        return getChildAt(self, entry.index) == entry.node &&
+            GeodeNodeMetadata::getNodeID(entry.node) == id;
+    }
+
+    static bool isValidDescendant(CCNode* self, NodeID id, IndexedDescendant const& entry) {
+        auto node = self;
+        for (auto index : entry.path) {
+            if (!(node = getChildAt(node, index))) {
+                return false;
+            }
+        }
+        return node == entry.node && GeodeNodeMetadata::getNodeID(node) == id;
+    }
+
+    CCNode* findIndexedChild(CCNode* self, NodeID id) {
+        auto& index = this->getChildIndex(self);
+        auto it = index.find(id);
+        return it != index.end() ? it->second.node : nullptr;
+    }
+
+    CCNode* findIndexedDescendant(CCNode* self, NodeID id) {
+        auto& index = this->getSubtreeIndex(self);
+        auto it = index.find(id);
+        return it != index.end() ? it->second.node : nullptr;
+    }
+
+    NodeIDIndex const& getChildIndex(CCNode* self) {
+        if (!m_childIndexValid || m_childIndexGeneration != m_childGeneration) {
+            m_childIndex.clear();
+            unsigned int i = 0;
+            for (auto child : CCArrayExt<CCNode*>(self->getChildren())) {
+                if (auto id = GeodeNodeMetadata::getNodeID(child)) {
+                    m_childIndex.try_emplace(id, IndexedChild { child, i });
+                }
+                i += 1;
+            }
+            m_childIndexValid = true;
+            m_childIndexGeneration = m_childGeneration;
+            m_childIndexFrame = getCurrentFrame();
+            m_childIndexCount = self->getChildrenCount();
+        }
+        return m_childIndex;
+    }
+
+    NodeIDSubtreeIndex const& getSubtreeIndex(CCNode* self) {
+        // any change in the subtree could affect this index, and finding out 
+        // whether one happened in this subtree would take a walk through it, 
+        // so any change anywhere invalidates it
+        if (!m_subtreeIndexValid || m_subtreeIndexGeneration != s_nodeTreeGeneration) {
+            m_subtreeIndex.clear();
+            std::vector<unsigned int> path;
+            GeodeNodeMetadata::collectSubtreeIDs(self, path, m_subtreeIndex);
+            m_subtreeIndexValid = true;
+            m_subtreeIndexGeneration = s_nodeTreeGeneration;
+            m_subtreeIndexFrame = getCurrentFrame();
+        }
+        return m_subtreeIndex;
+    }
+
+    static CCNode* searchDescendant(CCNode* node, NodeID id) {
+        auto children = CCArrayExt<CCNode*>(node->getChildren());
+        for (auto child : children) {
+            if (GeodeNodeMetadata::getNodeID(child) == id) {
+                return child;
+            }
+        }
+        for (auto child : children) {
+            if (auto found = GeodeNodeMetadata::searchDescendant(child, id)) {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+    // immediate children take priority over deeper ones, and earlier 
+    // children's subtrees over later ones, same as searchDescendant
+    static void collectSubtreeIDs(
+        CCNode* node, std::vector<unsigned int>& path, NodeIDSubtreeIndex& index
+    ) {
+        auto children = CCArrayExt<CCNode*>(node->getChildren());
+        unsigned int i = 0;
+        for (auto child : children) {
+            if (auto id = GeodeNodeMetadata::getNodeID(child)) {
+                if (!index.contains(id)) {
+                    path.push_back(i);
+                    index.emplace(id, IndexedDescendant { child, path });
+                    path.pop_back();
+                }
+            }
+            i += 1;
+        }
+        i = 0;
+        for (auto child : children) {
+            path.push_back(i);
+            GeodeNodeMetadata::collectSubtreeIDs(child, path, index);
+            path.pop_back();
+            i += 1;
+        }
+    }
+
     FieldContainer* getFieldContainer() {
+        if (!m_fieldContainer) {
+            m_fieldContainer = new FieldContainer(0);
+        }
         return m_fieldContainer;
     }
 
-    FieldContainer* getFieldContainer(char const* forClass) {
-        if (!m_classFieldContainers.count(forClass)) {
-            m_classFieldContainers[forClass] = new FieldContainer();
+    FieldContainer* getFieldContainer(size_t forClassID) {
+        for (auto& [id, container] : m_classFieldContainers) {
+            if (id == forClassID) {
+                return container;
+            }
         }
-        return m_classFieldContainers[forClass];
+        auto container = new FieldContainer(forClassID);
+        m_classFieldContainers.push_back({ forClassID, container });
+        return container;
     }
 };
 
@@ -99,11 +369,128 @@ struct ProxyCCNode : Modify<ProxyCCNode, CCNode> {
             CC_SAFE_RETAIN(m_pUserObject);
         }
     }
+
+    // let the ID indices know they're out of date. removeChild(CCNode*), 
+    // removeChildByTag and removeFromParent all end up in 
+    // removeChild(CCNode*, bool)
+    virtual void addChild(CCNode* child, int zOrder, int tag) {
+        CCNode::addChild(child, zOrder, tag);
+        GeodeNodeMetadata::markChildrenChanged(this);
+    }
+    virtual void removeChild(CCNode* child, bool cleanup) {
+        CCNode::removeChild(child, cleanup);
+        GeodeNodeMetadata::markChildrenChanged(this);
+    }
+    virtual void removeAllChildrenWithCleanup(bool cleanup) {
+        CCNode::removeAllChildrenWithCleanup(cleanup);
+        GeodeNodeMetadata::markChildrenChanged(this);
+    }
+    // the indices point to the first child with an ID, which depends on the 
+    // order of the children. the sort itself happens later on, which the 
+    // position checks of the indices catch
+    virtual void reorderChild(CCNode* child, int zOrder) {
+        CCNode::reorderChild(child, zOrder);
+        GeodeNodeMetadata::markChildrenChanged(this);
+    }
 };
 
-static inline std::unordered_map<std::string, size_t> s_nextIndex;
-size_t modifier::getFieldIndexForClass(char const* name) {
-	return s_nextIndex[name]++;
+namespace {
+    struct FieldLayout {
+        size_t offset;
+        size_t size;
+        size_t alignment;
+        void (*destructor)(void*);
+    };
+
+    struct FieldClassLayout {
+        std::vector<FieldLayout> fields;
+        size_t blockSize = 0;
+        size_t blockAlignment = alignof(void*);
+    };
+
+    // class ID -> layout of the fields of all modifications of that class. 
+    // function-local so it's safe to use from other static initializers. 
+    // ID 0 is reserved for the deprecated class-less container
+    std::vector<FieldClassLayout>& getFieldClassLayouts() {
+        static std::vector<FieldClassLayout> layouts(1);
+        return layouts;
+    }
+
+    std::unordered_map<std::string, size_t>& getFieldClassIDs() {
+        static std::unordered_map<std::string, size_t> ids;
+        return ids;
+    }
+}
+
+static size_t getFieldClassID(char const* forClass) {
+    auto& layouts = getFieldClassLayouts();
+    auto [it, created] = getFieldClassIDs().try_emplace(forClass, layouts.size());
+    if (created) {
+        layouts.emplace_back();
+    }
+    return it->second;
+}
+
+FieldRegistration modifier::registerField(
+    char const* forClass, size_t size, size_t alignment, void (*destructor)(void*)
+) {
+    auto classID = getFieldClassID(forClass);
+    auto& layout = getFieldClassLayouts().at(classID);
+    // pack the fields one after another, respecting their alignment
+    auto offset = (layout.blockSize + alignment - 1) / alignment * alignment;
+    layout.fields.push_back({ offset, size, alignment, destructor });
+    layout.blockSize = offset + size;
+    layout.blockAlignment = std::max(layout.blockAlignment, alignment);
+    return { classID, layout.fields.size() - 1 };
+}
+
+FieldContainer::FieldContainer(size_t classID) : m_classID(classID) {
+    auto& layout = getFieldClassLayouts().at(classID);
+    m_blockFieldCount = layout.fields.size();
+    m_fields.resize(m_blockFieldCount, nullptr);
+    if (layout.blockSize) {
+        m_block = static_cast<std::byte*>(operator new(
+            layout.blockSize, std::align_val_t(layout.blockAlignment)
+        ));
+    }
+}
+
+FieldContainer::~FieldContainer() {
+    auto& layout = getFieldClassLayouts().at(m_classID);
+    // the layout's alignment may have grown from fields registered after 
+    // the block was allocated, so recompute the one it was allocated with
+    size_t blockAlignment = alignof(void*);
+    for (size_t i = 0; i < m_fields.size(); i++) {
+        auto& field = layout.fields.at(i);
+        if (i < m_blockFieldCount) {
+            blockAlignment = std::max(blockAlignment, field.alignment);
+        }
+        if (!m_fields[i]) continue;
+        field.destructor(m_fields[i]);
+        if (i >= m_blockFieldCount) {
+            operator delete(m_fields[i], std::align_val_t(field.alignment));
+        }
+    }
+    if (m_block) {
+        operator delete(m_block, std::align_val_t(blockAlignment));
+    }
+}
+
+void* FieldContainer::setField(size_t index) {
+    auto& layout = getFieldClassLayouts().at(m_classID);
+    auto& field = layout.fields.at(index);
+    if (index >= m_fields.size()) {
+        m_fields.resize(index + 1, nullptr);
+    }
+    if (index < m_blockFieldCount) {
+        m_fields[index] = m_block + field.offset;
+    }
+    else {
+        // registered after this container was created, so it has no place 
+        // in the block
+        m_fields[index] = operator new(field.size, std::align_val_t(field.alignment));
+    }
+    return m_fields[index];
 }
 
 // not const because might modify contents
@@ -111,93 +498,119 @@ FieldContainer* CCNode::getFieldContainer() {
     return GeodeNodeMetadata::set(this)->getFieldContainer();
 }
 
-FieldContainer* CCNode::getFieldContainer(char const* forClass) {
-    return GeodeNodeMetadata::set(this)->getFieldContainer(forClass);
+FieldContainer* CCNode::getFieldContainer(size_t forClassID) {
+    return GeodeNodeMetadata::set(this)->getFieldContainer(forClassID);
 }
 
 std::string CCNode::getID() {
-    return GeodeNodeMetadata::set(this)->m_id;
+    auto id = GeodeNodeMetadata::set(this)->m_id;
+    return id ? *id : "";
 }
 
 void CCNode::setID(std::string const& id) {
-    GeodeNodeMetadata::set(this)->m_id = id;
+    GeodeNodeMetadata::set(this)->m_id = internNodeID(id);
+    if (m_pParent) {
+        GeodeNodeMetadata::markChildrenChanged(m_pParent);
+    }
 }
 
 CCNode* CCNode::getChildByID(std::string const& id) {
-    for (auto child : CCArrayExt<CCNode*>(m_pChildren)) {
-        if (child->getID() == id) {
-            return child;
-        }
+    auto nodeID = findNodeID(id);
+    if (!nodeID || !m_pChildren || !m_pChildren->count()) {
+        return nullptr;
     }
-    return nullptr;
+    return GeodeNodeMetadata::set(this)->findChild(this, nodeID);
 }
 
 CCNode* CCNode::getChildByIDRecursive(std::string const& id) {
-    if (auto child = this->getChildByID(id)) {
-        return child;
-    }
-    for (auto child : CCArrayExt<CCNode*>(m_pChildren)) {
-        if ((child = child->getChildByIDRecursive(id))) {
-            return child;
-        }
+    auto nodeID = findNodeID(id);
+    if (!nodeID || !m_pChildren || !m_pChildren->count()) {
+        return nullptr;
     }
-    return nullptr;
+    return GeodeNodeMetadata::set(this)->findDescendant(this, nodeID);
 }
 
-class BFSNodeTreeCrawler final {
+class NodeQuery final {
 private:
-    std::queue<CCNode*> m_queue;
-    std::unordered_set<CCNode*> m_explored;
+    enum class Op {
+        ImmediateChild,
+        DescendantChild,
+    };
 
-public:
-    BFSNodeTreeCrawler(CCNode* target) {
-        if (auto first = getChild(target, 0)) {
-            m_explored.insert(first);
-            m_queue.push(first);
+    struct Step {
+        // interned ID to match, or null to match any node
+        NodeID id;
+        // how the node matching the next step relates to this one
+        Op nextOp;
+    };
+
+    std::vector<Step> m_steps;
+
+    static bool matches(CCNode* node, NodeID id) {
+        return !id || GeodeNodeMetadata::getNodeID(node) == id;
+    }
+
+    // matching is only done on the main thread and never re-entered, so the 
+    // same buffers can be used for every query. each step gets its own since
+    // descendant searches nest
+    static std::vector<std::vector<CCNode*>>& getScratch(size_t steps) {
+        static std::vector<std::vector<CCNode*>> scratch;
+        if (scratch.size() < steps) {
+            scratch.resize(steps);
         }
+        return scratch;
     }
 
-    CCNode* next() {
-        if (m_queue.empty()) {
+    CCNode* match(CCNode* node, size_t stepIndex, std::vector<std::vector<CCNode*>>& scratch) const {
+        auto& step = m_steps[stepIndex];
+        // Make sure this matches the ID being looked for
+        if (!matches(node, step.id)) {
             return nullptr;
         }
-        auto node = m_queue.front();
-        m_queue.pop();
-        for (auto sibling : CCArrayExt<CCNode*>(node->getParent()->getChildren())) {
-            if (!m_explored.contains(sibling)) {
-                m_explored.insert(sibling);
-                m_queue.push(sibling);
-            }
+        // If this is the last thing to match, return the result
+        if (stepIndex + 1 == m_steps.size()) {
+            return node;
         }
-        for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
-            if (!m_explored.contains(child)) {
-                m_explored.insert(child);
-                m_queue.push(child);
-            }
+        switch (step.nextOp) {
+            case Op::ImmediateChild: {
+                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
+                    if (auto r = this->match(c, stepIndex + 1, scratch)) {
+                        return r;
+                    }
+                }
+            } break;
+
+            case Op::DescendantChild: {
+                // breadth-first, using the buffer as a queue
+                auto& queue = scratch[stepIndex];
+                queue.clear();
+                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
+                    queue.push_back(c);
+                }
+                for (size_t i = 0; i < queue.size(); i++) {
+                    auto c = queue[i];
+                    if (auto r = this->match(c, stepIndex + 1, scratch)) {
+                        return r;
+                    }
+                    for (auto child : CCArrayExt<CCNode*>(c->getChildren())) {
+                        queue.push_back(child);
+                    }
+                }
+            } break;
         }
-        return node;
+        return nullptr;
     }
-};
-
-class NodeQuery final {
-private:
-    enum class Op {
-        ImmediateChild,
-        DescendantChild,
-    };
-
-    std::string m_targetID;
-    Op m_nextOp;
-    std::unique_ptr<NodeQuery> m_next = nullptr;
 
 public:
-    static Result<std::unique_ptr<NodeQuery>> parse(std::string const& query) {
+    static Result<NodeQuery> parse(std::string const& query) {
         if (query.empty()) {
             return Err("Query may not be empty");
         }
 
-        auto result = std::make_unique<NodeQuery>();
-        NodeQuery* current = result.get();
+        NodeQuery result;
+        // the first step is the node the query is ran on, which can have any 
+        // ID (internNodeID gives null for the empty ID)
+        Step current {};
 
         size_t i = 0;
         std::string collectedID;
@@ -221,10 +634,10 @@ public:
             // ID-valid characters
             else if (std::isalnum(c) || c == '-' || c == '_' || c == '/' || c == '.') {
                 if (nextOp) {
-                    current->m_next = std::make_unique<NodeQuery>();
-                    current->m_nextOp = *nextOp;
-                    current->m_targetID = collectedID;
-                    current = current->m_next.get();
+                    // interned so matching can compare pointers
+                    current.id = internNodeID(collectedID);
+                    current.nextOp = *nextOp;
+                    result.m_steps.push_back(current);
 
                     collectedID = "";
                     nextOp = std::nullopt;
@@ -241,63 +654,128 @@ public:
         if (nextOp || collectedID.empty()) {
             return Err("Expected node ID but got end of query");
         }
-        current->m_targetID = collectedID;
+        current.id = internNodeID(collectedID);
+        result.m_steps.push_back(current);
 
         return Ok(std::move(result));
     }
 
     CCNode* match(CCNode* node) const {
-        // Make sure this matches the ID being looked for
-        if (!m_targetID.empty() && node->getID() != m_targetID) {
-            return nullptr;
-        }
-        // If this is the last thing to match, return the result
-        if (!m_next) {
-            return node;
+        return this->match(node, 0, getScratch(m_steps.size()));
+    }
+
+    /**
+     * Find all matching nodes in one pass. Instead of searching from every 
+     * node that matches a step, the nodes matching each step are collected 
+     * and the next step searches from all of them at once, so overlapping 
+     * subtrees are only walked once
+     */
+    std::vector<CCNode*> matchAll(CCNode* node) const {
+        std::vector<CCNode*> frontier;
+        if (!matches(node, m_steps.front().id)) {
+            return frontier;
         }
-        switch (m_nextOp) {
-            case Op::ImmediateChild: {
-                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
-                    if (auto r = m_next->match(c)) {
-                        return r;
+        frontier.push_back(node);
+
+        std::vector<CCNode*> next;
+        static std::unordered_set<CCNode*> visited;
+        for (size_t stepIndex = 0; stepIndex + 1 < m_steps.size(); stepIndex++) {
+            auto nextID = m_steps[stepIndex + 1].id;
+            next.clear();
+            switch (m_steps[stepIndex].nextOp) {
+                case Op::ImmediateChild: {
+                    // nodes in the frontier are unique, so their children are too
+                    for (auto f : frontier) {
+                        for (auto c : CCArrayExt<CCNode*>(f->getChildren())) {
+                            if (matches(c, nextID)) {
+                                next.push_back(c);
+                            }
+                        }
                     }
-                }
-            } break;
-
-            case Op::DescendantChild: {
-                auto crawler = BFSNodeTreeCrawler(node);
-                while (auto c = crawler.next()) {
-                    if (auto r = m_next->match(c)) {
-                        return r;
+                } break;
+
+                case Op::DescendantChild: {
+                    visited.clear();
+                    auto& queue = getScratch(1).front();
+                    queue.clear();
+                    for (auto f : frontier) {
+                        for (auto c : CCArrayExt<CCNode*>(f->getChildren())) {
+                            queue.push_back(c);
+                        }
                     }
-                }
-            } break;
+                    for (size_t i = 0; i < queue.size(); i++) {
+                        auto c = queue[i];
+                        // the subtree of a frontier node that's inside another 
+                        // frontier node's subtree has already been walked
+                        if (!visited.insert(c).second) {
+                            continue;
+                        }
+                        if (matches(c, nextID)) {
+                            next.push_back(c);
+                        }
+                        for (auto child : CCArrayExt<CCNode*>(c->getChildren())) {
+                            queue.push_back(child);
+                        }
+                    }
+                } break;
+            }
+            std::swap(frontier, next);
+            if (frontier.empty()) {
+                break;
+            }
         }
-        return nullptr;
+        return frontier;
     }
 
     std::string toString() const {
-        auto str = m_targetID.empty() ? "&" : m_targetID;
-        if (m_next) {
-            switch (m_nextOp) {
-                case Op::ImmediateChild: str += " > "; break;
-                case Op::DescendantChild: str += " "; break;
+        std::string str;
+        for (size_t i = 0; i < m_steps.size(); i++) {
+            str += m_steps[i].id ? *m_steps[i].id : "&";
+            if (i + 1 < m_steps.size()) {
+                switch (m_steps[i].nextOp) {
+                    case Op::ImmediateChild: str += " > "; break;
+                    case Op::DescendantChild: str += " "; break;
+                }
             }
-            str += m_next->toString();
         }
         return str;
     }
 };
 
+// queries are usually string literals ran over and over again, so they're 
+// only parsed once
+static Result<NodeQuery const*> getCompiledQuery(std::string const& queryStr) {
+    static std::unordered_map<std::string, Result<NodeQuery>> cache;
+    auto it = cache.find(queryStr);
+    if (it == cache.end()) {
+        // queries built at runtime could fill this up indefinitely
+        if (cache.size() >= 512) {
+            cache.clear();
+        }
+        it = cache.emplace(queryStr, NodeQuery::parse(queryStr)).first;
+    }
+    if (!it->second) {
+        return Err(it->second.unwrapErr());
+    }
+    return Ok(&it->second.unwrap());
+}
+
 CCNode* CCNode::querySelector(std::string const& queryStr) {
-    auto res = NodeQuery::parse(queryStr);
+    auto res = getCompiledQuery(queryStr);
     if (!res) {
         log::error("Invalid CCNode::querySelector query '{}': {}", queryStr, res.unwrapErr());
         return nullptr;
     }
-    auto query = std::move(res.unwrap());
-    log::info("parsed query: {}", query->toString());
-    return query->match(this);
+    return res.unwrap()->match(this);
+}
+
+std::vector<CCNode*> CCNode::querySelectorAll(std::string const& queryStr) {
+    auto res = getCompiledQuery(queryStr);
+    if (!res) {
+        log::error("Invalid CCNode::querySelectorAll query '{}': {}", queryStr, res.unwrapErr());
+        return {};
+    }
+    return res.unwrap()->matchAll(this);
 }
 
 void CCNode::removeChildByID(std::string const& id) {
@@ -12,6 +12,8 @@ namespace {
 
         auto begin = std::chrono::high_resolution_clock::now();
 
+        // only queues the mods whose data changed, the files are written on
+        // a background thread and anything still queued is flushed on exit
         (void)Loader::get()->saveData();
 
         auto end = std::chrono::high_resolution_clock::now();
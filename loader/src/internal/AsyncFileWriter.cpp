@@ -0,0 +1,115 @@
+#include "AsyncFileWriter.hpp"
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/general.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+
+using namespace geode::prelude;
+
+AsyncFileWriter::AsyncFileWriter(std::string name) : m_name(std::move(name)) {
+    // never joined, the writer lives until the game exits
+    std::thread(&AsyncFileWriter::work, this).detach();
+}
+
+AsyncFileWriter* AsyncFileWriter::get() {
+    static auto inst = [] {
+        // intentionally leaked, like the other loader workers
+        auto writer = new AsyncFileWriter("Data Writer");
+        std::atexit([] {
+            AsyncFileWriter::get()->flush();
+        });
+        return writer;
+    }();
+    return inst;
+}
+
+void AsyncFileWriter::writeAll(Pending& pending) {
+    for (auto& job : pending) {
+        auto res = job.run();
+        if (!res) {
+            log::error("Unable to write {}: {}", job.path.string(), res.unwrapErr());
+            if (job.onFailure) {
+                job.onFailure();
+            }
+        }
+    }
+}
+
+void AsyncFileWriter::work() {
+    thread::setName(m_name);
+    while (true) {
+        Pending pending;
+        {
+            std::unique_lock lock(m_mutex);
+            m_pendingCV.wait(lock, [this] { return !m_pending.empty(); });
+            pending = std::move(m_pending);
+            m_pending.clear();
+            for (auto& job : pending) {
+                m_writingPaths.push_back(job.path);
+            }
+        }
+        writeAll(pending);
+        {
+            std::lock_guard lock(m_mutex);
+            m_writingPaths.clear();
+        }
+        m_idleCV.notify_all();
+    }
+}
+
+void AsyncFileWriter::queue(Job job) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (job.replaces) {
+            std::erase_if(m_pending, [&](Job const& other) {
+                return other.path == job.path;
+            });
+        }
+        m_pending.push_back(std::move(job));
+    }
+    m_pendingCV.notify_one();
+}
+
+void AsyncFileWriter::write(ghc::filesystem::path const& path, Serializer serialize, FailureCallback onFailure) {
+    this->queue(Job {
+        path, true,
+        [path, serialize = std::move(serialize)]() {
+            return file::writeStringSafe(path, serialize());
+        },
+        std::move(onFailure)
+    });
+}
+
+void AsyncFileWriter::update(ghc::filesystem::path const& path, Updater update, FailureCallback onFailure) {
+    this->queue(Job { path, false, std::move(update), std::move(onFailure) });
+}
+
+void AsyncFileWriter::flush() {
+    Pending pending;
+    {
+        // the writer thread may already have been killed if this is called 
+        // while exiting, possibly while holding the lock
+        std::unique_lock lock(m_mutex, std::defer_lock);
+        if (!lock.try_lock_for(std::chrono::seconds(1))) {
+            return;
+        }
+        m_idleCV.wait_for(lock, std::chrono::seconds(1), [this] { return m_writingPaths.empty(); });
+        pending = std::move(m_pending);
+        m_pending.clear();
+        // writing a file the writer thread is still busy with could mix up 
+        // the two writes, so those stay queued for it
+        auto isBeingWritten = [this](Job const& job) {
+            return std::find(m_writingPaths.begin(), m_writingPaths.end(), job.path) != m_writingPaths.end();
+        };
+        auto busy = std::stable_partition(pending.begin(), pending.end(), [&](Job const& job) {
+            return !isBeingWritten(job);
+        });
+        std::move(busy, pending.end(), std::back_inserter(m_pending));
+        pending.erase(busy, pending.end());
+    }
+    writeAll(pending);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/utils/MiniFunction.hpp>
+#include <Geode/utils/Result.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Writes files atomically on a dedicated thread, so saving doesn't block the
+ * thread it's requested from. Writes to a file that is already waiting to be
+ * written replace the older contents instead of writing the file twice
+ */
+class AsyncFileWriter {
+public:
+    // produces the contents of the file, called on the writer thread
+    using Serializer = geode::utils::MoveOnlyMiniFunction<std::string()>;
+    // changes the file in place, called on the writer thread
+    using Updater = geode::utils::MoveOnlyMiniFunction<geode::Result<>()>;
+    // called on the writer thread if a write failed, so it can be retried
+    using FailureCallback = geode::utils::MoveOnlyMiniFunction<void()>;
+
+protected:
+    struct Job {
+        ghc::filesystem::path path;
+        // jobs that rewrite the whole file make earlier jobs on it redundant
+        bool replaces;
+        Updater run;
+        FailureCallback onFailure;
+    };
+    using Pending = std::vector<Job>;
+
+    std::string m_name;
+    // timed so flushing while exiting can give up if the writer thread was
+    // killed while holding it
+    std::timed_mutex m_mutex;
+    std::condition_variable_any m_pendingCV;
+    std::condition_variable_any m_idleCV;
+    // kept in the order files were queued in
+    Pending m_pending;
+    // files the writer thread is writing right now
+    std::vector<ghc::filesystem::path> m_writingPaths;
+
+    void work();
+    void queue(Job job);
+    static void writeAll(Pending& pending);
+
+public:
+    explicit AsyncFileWriter(std::string name);
+    AsyncFileWriter(AsyncFileWriter const&) = delete;
+    AsyncFileWriter& operator=(AsyncFileWriter const&) = delete;
+
+    /**
+     * Get the writer used for mod data. Everything queued on it is flushed
+     * when the game exits
+     */
+    static AsyncFileWriter* get();
+
+    /**
+     * Queue a file to be written
+     * @param onFailure Called if writing the file fails. Not called if the
+     * write is replaced by a later one before it happens
+     */
+    void write(ghc::filesystem::path const& path, Serializer serialize, FailureCallback onFailure = nullptr);
+
+    /**
+     * Queue a change to a file that builds on its current contents, like 
+     * appending to it. Updates are only dropped if a later write replaces 
+     * the whole file
+     */
+    void update(ghc::filesystem::path const& path, Updater update, FailureCallback onFailure = nullptr);
+
+    /**
+     * Wait for the write in progress to finish and write everything that's 
+     * still queued on the calling thread. If the writer thread doesn't 
+     * finish in time, files it's still writing are left to it
+     */
+    void flush();
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/**
+ * Unbounded lock-free queue that any number of threads can push into, but
+ * only one thread may pop from. Values are only ever moved, never copied
+ */
+template <class T>
+class MPSCQueue {
+protected:
+    struct Node {
+        std::atomic<Node*> m_next = nullptr;
+        T m_value;
+    };
+
+    // producers append after the head, the consumer reads after the tail,
+    // which is always a node whose value has already been taken
+    std::atomic<Node*> m_head;
+    Node* m_tail;
+
+public:
+    MPSCQueue() {
+        auto stub = new Node();
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+    MPSCQueue(MPSCQueue const&) = delete;
+    MPSCQueue& operator=(MPSCQueue const&) = delete;
+
+    ~MPSCQueue() {
+        while (m_tail) {
+            auto next = m_tail->m_next.load(std::memory_order_relaxed);
+            delete m_tail;
+            m_tail = next;
+        }
+    }
+
+    /**
+     * Push a value, safe to call from any thread
+     */
+    void push(T value) {
+        auto node = new Node();
+        node->m_value = std::move(value);
+        auto prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->m_next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Pop a value, may only be called from the consumer thread
+     * @returns False if the queue was empty. A push that is still in
+     * progress on another thread may not be visible yet
+     */
+    bool pop(T& out) {
+        auto next = m_tail->m_next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(next->m_value);
+        delete m_tail;
+        m_tail = next;
+        return true;
+    }
+};
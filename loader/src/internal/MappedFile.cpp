@@ -0,0 +1,103 @@
+#include "MappedFile.hpp"
+
+
+#ifdef GEODE_IS_WINDOWS
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace geode::prelude;
+
+#ifdef GEODE_IS_WINDOWS
+
+Result<std::unique_ptr<MappedFile>> MappedFile::open(ghc::filesystem::path const& path) {
+    // allow the file to be replaced while it's mapped, for example by a 
+    // newer version of it
+    auto file = CreateFileW(
+        path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return Err("Unable to open file");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return Err("Unable to map empty file");
+    }
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // the mapping keeps the file open on its own
+    CloseHandle(file);
+    if (!mapping) {
+        return Err("Unable to map file");
+    }
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return Err("Unable to map file");
+    }
+
+    auto res = std::unique_ptr<MappedFile>(new MappedFile());
+    res->m_data = static_cast<uint8_t const*>(view);
+    res->m_size = static_cast<size_t>(size.QuadPart);
+    res->m_mapping = mapping;
+    return Ok(std::move(res));
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+}
+
+#else
+
+Result<std::unique_ptr<MappedFile>> MappedFile::open(ghc::filesystem::path const& path) {
+    auto fd = ::open(path.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return Err("Unable to open file");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return Err("Unable to map empty file");
+    }
+    auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file open on its own
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return Err("Unable to map file");
+    }
+
+    auto res = std::unique_ptr<MappedFile>(new MappedFile());
+    res->m_data = static_cast<uint8_t const*>(view);
+    res->m_size = static_cast<size_t>(info.st_size);
+    return Ok(std::move(res));
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+}
+
+#endif
+
+uint8_t const* MappedFile::data() const {
+    return m_data;
+}
+
+size_t MappedFile::size() const {
+    return m_size;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(reinterpret_cast<char const*>(m_data), m_size);
+}
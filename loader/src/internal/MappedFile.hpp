@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/utils/Result.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/**
+ * A read-only view of a whole file mapped into memory. The file stays
+ * mapped until the object is destroyed, so views into it may be kept around
+ * for as long as the object is
+ */
+class MappedFile {
+protected:
+    uint8_t const* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef GEODE_IS_WINDOWS
+    void* m_mapping = nullptr;
+#endif
+
+    MappedFile() = default;
+
+public:
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    /**
+     * Map a file. Empty files can't be mapped
+     */
+    static geode::Result<std::unique_ptr<MappedFile>> open(ghc::filesystem::path const& path);
+
+    uint8_t const* data() const;
+    size_t size() const;
+    std::string_view view() const;
+};
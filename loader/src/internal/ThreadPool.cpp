@@ -0,0 +1,122 @@
+#include "ThreadPool.hpp"
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/general.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace geode::prelude;
+
+ThreadPool::ThreadPool(std::string name, size_t threadCount) : m_name(std::move(name)) {
+    if (threadCount == 0) {
+        // leave one core for the main thread
+        auto cores = std::thread::hardware_concurrency();
+        threadCount = std::clamp<size_t>(cores > 1 ? cores - 1 : 1, 1, 8);
+    }
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_exiting = true;
+    }
+    m_taskCV.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+ThreadPool* ThreadPool::get() {
+    // intentionally leaked, joining workers during static destruction is
+    // asking for trouble on platforms that kill threads before that
+    static auto inst = new ThreadPool("Loader Worker");
+    return inst;
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return m_workers.size();
+}
+
+void ThreadPool::work() {
+    thread::setName(m_name);
+    while (true) {
+        Task task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_taskCV.wait(lock, [this] { return m_exiting || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        try {
+            task();
+        }
+        catch (std::exception const& e) {
+            log::error("Uncaught exception in worker task: {}", e.what());
+        }
+    }
+}
+
+void ThreadPool::push(Task task) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskCV.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, MiniFunction<void(size_t)> const& func) {
+    if (count == 0) {
+        return;
+    }
+
+    // helpers may only get scheduled after the calling thread has already
+    // finished the whole batch, so the shared state has to outlive this call
+    struct Batch {
+        std::atomic_size_t next = 0;
+        size_t pending;
+        std::mutex mutex;
+        std::condition_variable doneCV;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->pending = count;
+
+    // func is only ever called while the batch is unfinished, so capturing it
+    // by reference is fine
+    auto run = [batch, &func, count]() {
+        size_t finished = 0;
+        for (size_t i; (i = batch->next.fetch_add(1)) < count; finished++) {
+            try {
+                func(i);
+            }
+            catch (std::exception const& e) {
+                log::error("Uncaught exception in worker task: {}", e.what());
+            }
+        }
+        if (finished) {
+            std::lock_guard lock(batch->mutex);
+            batch->pending -= finished;
+            if (batch->pending == 0) {
+                batch->doneCV.notify_all();
+            }
+        }
+    };
+
+    auto helpers = std::min(count - 1, m_workers.size());
+    for (size_t i = 0; i < helpers; i++) {
+        this->push(run);
+    }
+    run();
+
+    std::unique_lock lock(batch->mutex);
+    batch->doneCV.wait(lock, [&] { return batch->pending == 0; });
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/utils/MiniFunction.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size worker pool for loader jobs that can be spread over multiple
+ * cores, like reading mod metadata or unzipping mods
+ */
+class ThreadPool {
+public:
+    using Task = geode::utils::MoveOnlyMiniFunction<void()>;
+
+protected:
+    std::string m_name;
+    std::vector<std::thread> m_workers;
+    std::deque<Task> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskCV;
+    bool m_exiting = false;
+
+    void work();
+
+public:
+    /**
+     * Create a pool
+     * @param name Name given to the worker threads
+     * @param threadCount Amount of workers, 0 picks one based on the
+     * amount of available cores
+     */
+    explicit ThreadPool(std::string name, size_t threadCount = 0);
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ~ThreadPool();
+
+    /**
+     * Get the pool shared by the loader internals
+     */
+    static ThreadPool* get();
+
+    size_t getThreadCount() const;
+
+    /**
+     * Queue a task to run on one of the workers
+     */
+    void push(Task task);
+
+    /**
+     * Run func(0) ... func(count - 1) spread over the workers and the
+     * calling thread, and block until all of them have finished. Exceptions
+     * thrown by func are logged and swallowed
+     */
+    void parallelFor(size_t count, geode::utils::MiniFunction<void(size_t)> const& func);
+};
@@ -0,0 +1,331 @@
+#include "WebCache.hpp"
+#include "AsyncFileWriter.hpp"
+
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/string.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+using namespace geode::prelude;
+
+static constexpr char const* INDEX_FILE = "index.json";
+static constexpr int INDEX_VERSION = 1;
+
+static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+static std::string makeKey(
+    std::string const& url, std::vector<std::string> const& vary, WebCache::Headers const& request
+) {
+    std::string id = url;
+    for (auto& name : vary) {
+        id += '\n';
+        id += name;
+        id += ':';
+        id += WebCache::findHeader(request, name).value_or("");
+    }
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto c : id) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return fmt::format("{:016x}", hash);
+}
+
+// header names are case insensitive
+static bool isSameHeader(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(x) == std::tolower(y);
+    });
+}
+
+namespace {
+    struct CacheControl {
+        bool noStore = false;
+        bool noCache = false;
+        std::optional<int64_t> maxAge;
+    };
+}
+
+static CacheControl parseCacheControl(WebCache::Headers const& headers) {
+    CacheControl res;
+    auto header = WebCache::findHeader(headers, "Cache-Control");
+    if (!header) {
+        return res;
+    }
+    for (auto directive : string::split(string::toLower(*header), ",")) {
+        string::trimIP(directive);
+        if (directive == "no-store") {
+            res.noStore = true;
+        }
+        else if (directive == "no-cache") {
+            res.noCache = true;
+        }
+        else if (directive.starts_with("max-age=")) {
+            try {
+                res.maxAge = std::stoll(directive.substr(8));
+            }
+            catch (...) {}
+        }
+    }
+    return res;
+}
+
+static int64_t getExpiry(CacheControl const& control) {
+    if (control.noCache || !control.maxAge) {
+        return 0;
+    }
+    return now() + *control.maxAge;
+}
+
+bool WebCache::Entry::isFresh() const {
+    return expires > now();
+}
+
+std::optional<std::string> WebCache::Entry::getHeader(std::string_view name) const {
+    return WebCache::findHeader(headers, name);
+}
+
+std::optional<std::string> WebCache::findHeader(Headers const& headers, std::string_view name) {
+    for (auto& [key, value] : headers) {
+        if (isSameHeader(key, name)) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+WebCache::WebCache(ghc::filesystem::path dir, size_t maxSize)
+  : m_dir(std::move(dir)), m_maxSize(maxSize) {
+    this->load();
+}
+
+WebCache* WebCache::get() {
+    // intentionally leaked, like the other loader workers
+    static auto inst = new WebCache(dirs::getGeodeDir() / "web-cache", 32 * 1024 * 1024);
+    return inst;
+}
+
+void WebCache::load() {
+    (void)file::createDirectoryAll(m_dir);
+
+    auto index = file::readJson(m_dir / INDEX_FILE);
+    if (index && index.unwrap().is_object()) {
+        auto& json = index.unwrap();
+        if (json["version"].is_number() && json["version"].as_double() == INDEX_VERSION && json["entries"].is_object()) {
+            for (auto& [key, value] : json["entries"].as_object()) {
+                if (!value.is_object() || !value["url"].is_string() || !ghc::filesystem::exists(m_dir / key)) {
+                    continue;
+                }
+                Entry entry;
+                entry.key = key;
+                entry.url = value["url"].as_string();
+                if (value["vary"].is_array()) {
+                    for (auto& name : value["vary"].as_array()) {
+                        if (name.is_string()) {
+                            entry.vary.push_back(name.as_string());
+                        }
+                    }
+                }
+                if (value["headers"].is_object()) {
+                    for (auto& [name, header] : value["headers"].as_object()) {
+                        if (header.is_string()) {
+                            entry.headers.insert({ name, header.as_string() });
+                        }
+                    }
+                }
+                entry.expires = static_cast<int64_t>(value["expires"].is_number() ? value["expires"].as_double() : 0);
+                entry.size = static_cast<size_t>(value["size"].is_number() ? value["size"].as_double() : 0);
+                entry.lastUsed = static_cast<int64_t>(value["last-used"].is_number() ? value["last-used"].as_double() : 0);
+                m_size += entry.size;
+                m_urls.insert({ entry.url, entry.key });
+                m_entries.insert({ entry.key, std::move(entry) });
+            }
+        }
+    }
+
+    // bodies of entries that never made it into the index
+    std::error_code ec;
+    for (auto& file : ghc::filesystem::directory_iterator(m_dir, ec)) {
+        auto name = file.path().filename().string();
+        if (name != INDEX_FILE && !m_entries.contains(name)) {
+            ghc::filesystem::remove(file.path(), ec);
+        }
+    }
+}
+
+void WebCache::saveIndex() {
+    matjson::Value entries = matjson::Object();
+    for (auto& [key, entry] : m_entries) {
+        matjson::Value value = matjson::Object();
+        value["url"] = entry.url;
+        matjson::Array vary;
+        for (auto& name : entry.vary) {
+            vary.push_back(name);
+        }
+        value["vary"] = vary;
+        matjson::Value headers = matjson::Object();
+        for (auto& [name, header] : entry.headers) {
+            headers[name] = header;
+        }
+        value["headers"] = headers;
+        value["expires"] = static_cast<double>(entry.expires);
+        value["size"] = static_cast<double>(entry.size);
+        value["last-used"] = static_cast<double>(entry.lastUsed);
+        entries[key] = value;
+    }
+    matjson::Value index = matjson::Object();
+    index["version"] = static_cast<double>(INDEX_VERSION);
+    index["entries"] = entries;
+    AsyncFileWriter::get()->write(m_dir / INDEX_FILE, [index = std::move(index)]() {
+        return index.dump(matjson::NO_INDENTATION);
+    });
+}
+
+void WebCache::insert(Entry entry) {
+    auto it = m_entries.find(entry.key);
+    if (it != m_entries.end()) {
+        m_size -= it->second.size;
+        it->second = std::move(entry);
+        m_size += it->second.size;
+    }
+    else {
+        m_size += entry.size;
+        m_urls.insert({ entry.url, entry.key });
+        m_entries.insert({ entry.key, std::move(entry) });
+    }
+    this->evict();
+}
+
+void WebCache::erase(std::string const& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    auto [begin, end] = m_urls.equal_range(it->second.url);
+    for (auto url = begin; url != end; ++url) {
+        if (url->second == key) {
+            m_urls.erase(url);
+            break;
+        }
+    }
+    m_size -= it->second.size;
+    m_entries.erase(it);
+
+    // may fail if the body is being read, in which case it's cleaned up
+    // the next time the cache is loaded
+    std::error_code ec;
+    ghc::filesystem::remove(m_dir / key, ec);
+}
+
+void WebCache::evict() {
+    while (m_size > m_maxSize && !m_entries.empty()) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(), [](auto const& a, auto const& b) {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        this->erase(oldest->first);
+    }
+}
+
+std::optional<WebCache::Entry> WebCache::find(std::string const& url, Headers const& request) {
+    std::lock_guard lock(m_mutex);
+    auto [begin, end] = m_urls.equal_range(url);
+    for (auto it = begin; it != end; ++it) {
+        auto& entry = m_entries.at(it->second);
+        if (makeKey(url, entry.vary, request) == entry.key) {
+            entry.lastUsed = now();
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+void WebCache::store(std::string const& url, Headers const& request, Headers const& response, std::string body) {
+    auto control = parseCacheControl(response);
+    if (control.noStore) {
+        return;
+    }
+    // a response that can neither be used as is nor revalidated would only
+    // ever be replaced by the next response
+    auto expires = getExpiry(control);
+    if (!expires && !findHeader(response, "ETag") && !findHeader(response, "Last-Modified")) {
+        return;
+    }
+    // don't let a single response push everything else out
+    if (body.size() > m_maxSize / 4) {
+        return;
+    }
+
+    Entry entry;
+    if (auto vary = findHeader(response, "Vary")) {
+        for (auto name : string::split(string::toLower(*vary), ",")) {
+            string::trimIP(name);
+            if (name == "*") {
+                return;
+            }
+            if (!name.empty()) {
+                entry.vary.push_back(name);
+            }
+        }
+        std::sort(entry.vary.begin(), entry.vary.end());
+    }
+    entry.key = makeKey(url, entry.vary, request);
+    entry.url = url;
+    entry.headers = response;
+    entry.expires = expires;
+    entry.size = body.size();
+    entry.lastUsed = now();
+
+    auto path = m_dir / entry.key;
+    AsyncFileWriter::get()->update(path, [this, path, entry = std::move(entry), body = std::move(body)]() mutable -> Result<> {
+        GEODE_UNWRAP(file::writeStringSafe(path, body));
+        std::lock_guard lock(m_mutex);
+        this->insert(std::move(entry));
+        this->saveIndex();
+        return Ok();
+    });
+}
+
+WebCache::Headers WebCache::refresh(Entry const& entry, Headers const& response) {
+    auto headers = entry.headers;
+    for (auto& [name, value] : response) {
+        // a 304 has no body, so its length says nothing about the stored one
+        if (isSameHeader(name, "Content-Length")) {
+            continue;
+        }
+        // replace the header regardless of the case it was stored with
+        std::erase_if(headers, [&](auto const& header) {
+            return isSameHeader(header.first, name);
+        });
+        headers.insert({ name, value });
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_entries.find(entry.key);
+    if (it != m_entries.end()) {
+        it->second.headers = headers;
+        it->second.expires = getExpiry(parseCacheControl(headers));
+        it->second.lastUsed = now();
+        this->saveIndex();
+    }
+    return headers;
+}
+
+Result<ByteVector> WebCache::read(Entry const& entry) {
+    GEODE_UNWRAP_INTO(auto data, file::readBinary(m_dir / entry.key));
+    if (data.size() != entry.size) {
+        return Err("Cached response has the wrong size");
+    }
+    return Ok(std::move(data));
+}
+
+void WebCache::remove(Entry const& entry) {
+    std::lock_guard lock(m_mutex);
+    this->erase(entry.key);
+    this->saveIndex();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/utils/Result.hpp>
+#include <Geode/utils/general.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <matjson.hpp>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Stores responses to web requests that asked to be cached, along with
+ * what's needed to ask the server whether they're still current. Responses
+ * are keyed by their URL and the values of the request headers their Vary
+ * header names. The least recently used responses are removed once the
+ * cache grows past its size limit
+ */
+class WebCache {
+public:
+    using Headers = std::unordered_map<std::string, std::string>;
+
+    struct Entry {
+        // also the name of the file the body is stored in
+        std::string key;
+        std::string url;
+        // lowercase names of the request headers the response depends on
+        std::vector<std::string> vary;
+        Headers headers;
+        // unix time until which the response may be used without asking
+        // the server, 0 if it always has to be revalidated
+        int64_t expires = 0;
+        size_t size = 0;
+        int64_t lastUsed = 0;
+
+        bool isFresh() const;
+        std::optional<std::string> getHeader(std::string_view name) const;
+    };
+
+protected:
+    ghc::filesystem::path m_dir;
+    size_t m_maxSize;
+    size_t m_size = 0;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    // keys of the entries for each url, since there may be multiple
+    // variants of the same url
+    std::unordered_multimap<std::string, std::string> m_urls;
+
+    void load();
+    void saveIndex();
+    void insert(Entry entry);
+    void erase(std::string const& key);
+    void evict();
+
+public:
+    WebCache(ghc::filesystem::path dir, size_t maxSize);
+    WebCache(WebCache const&) = delete;
+    WebCache& operator=(WebCache const&) = delete;
+
+    /**
+     * Get the cache used by utils::web
+     */
+    static WebCache* get();
+
+    /**
+     * Find the stored response for a request
+     * @param request Headers of the request
+     */
+    std::optional<Entry> find(std::string const& url, Headers const& request);
+
+    /**
+     * Store a response, unless the server said it may not be stored. The
+     * response is only found once it has been written to disk
+     * @param request Headers of the request
+     */
+    void store(std::string const& url, Headers const& request, Headers const& response, std::string body);
+
+    /**
+     * Update a stored response after the server said it's still current
+     * @param response Headers of the server's 304 response
+     * @returns The headers of the stored response updated with the new ones
+     */
+    Headers refresh(Entry const& entry, Headers const& response);
+
+    /**
+     * Read the body of a stored response
+     */
+    geode::Result<geode::ByteVector> read(Entry const& entry);
+
+    /**
+     * Forget a stored response, for example if its body couldn't be read
+     */
+    void remove(Entry const& entry);
+
+    static std::optional<std::string> findHeader(Headers const& headers, std::string_view name);
+};
@@ -0,0 +1,158 @@
+#include "WebClient.hpp"
+
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/general.hpp>
+#include <algorithm>
+#include <chrono>
+
+#ifndef _WIN32
+    #include <sys/select.h>
+#endif
+
+using namespace geode::prelude;
+
+// how long the network thread waits for socket activity before checking
+// for newly queued transfers. the bundled curl is too old to be woken up
+static constexpr long MAX_WAIT_MS = 10;
+
+WebClient::WebClient(std::string name, size_t maxTransfers)
+  : m_name(std::move(name)), m_maxTransfers(std::max<size_t>(maxTransfers, 1)) {
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    m_multi = curl_multi_init();
+    // keep connections of finished transfers around for the next ones
+    curl_multi_setopt(m_multi, CURLMOPT_MAXCONNECTS, static_cast<long>(m_maxTransfers * 2));
+
+    m_share = curl_share_init();
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, +[](CURL*, curl_lock_data data, curl_lock_access, void* self) {
+        static_cast<WebClient*>(self)->m_shareMutexes.at(data).lock();
+    });
+    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, +[](CURL*, curl_lock_data data, void* self) {
+        static_cast<WebClient*>(self)->m_shareMutexes.at(data).unlock();
+    });
+
+    // never joined, the client lives until the game exits
+    std::thread(&WebClient::work, this).detach();
+}
+
+WebClient* WebClient::get() {
+    // intentionally leaked, like the other loader workers
+    static auto inst = new WebClient("Web Client", 6);
+    return inst;
+}
+
+CURL* WebClient::createHandle() {
+    auto curl = curl_easy_init();
+    if (!curl) {
+        return nullptr;
+    }
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+    // No need to verify SSL, we trust our domains :-)
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    // signals can't be used for DNS timeouts off the main thread
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    return curl;
+}
+
+void WebClient::perform(CURL* handle, Completion done) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_queued.push_back(Transfer { handle, std::move(done) });
+    }
+    m_queuedCV.notify_one();
+}
+
+CURLcode WebClient::performSync(CURL* handle) {
+    // queueing this would make the caller wait for every transfer ahead of
+    // it, and waiting for the network thread on itself would never finish
+    return curl_easy_perform(handle);
+}
+
+void WebClient::startQueued() {
+    std::unique_lock lock(m_mutex);
+    if (m_active.empty()) {
+        m_queuedCV.wait(lock, [this] { return !m_queued.empty(); });
+    }
+    while (!m_queued.empty() && m_active.size() < m_maxTransfers) {
+        auto transfer = std::move(m_queued.front());
+        m_queued.pop_front();
+        auto res = curl_multi_add_handle(m_multi, transfer.handle);
+        if (res != CURLM_OK) {
+            log::error("Unable to start web request: {}", curl_multi_strerror(res));
+            lock.unlock();
+            transfer.done(CURLE_FAILED_INIT);
+            lock.lock();
+            continue;
+        }
+        m_active.insert({ transfer.handle, std::move(transfer.done) });
+    }
+}
+
+void WebClient::finishDone() {
+    int left = 0;
+    while (auto msg = curl_multi_info_read(m_multi, &left)) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        auto handle = msg->easy_handle;
+        auto result = msg->data.result;
+        curl_multi_remove_handle(m_multi, handle);
+
+        auto it = m_active.find(handle);
+        if (it == m_active.end()) {
+            continue;
+        }
+        auto done = std::move(it->second);
+        m_active.erase(it);
+        done(result);
+    }
+}
+
+void WebClient::waitForActivity() {
+    long timeout = -1;
+    curl_multi_timeout(m_multi, &timeout);
+    if (timeout < 0 || timeout > MAX_WAIT_MS) {
+        timeout = MAX_WAIT_MS;
+    }
+    if (timeout == 0) {
+        return;
+    }
+
+    fd_set readFds, writeFds, errorFds;
+    FD_ZERO(&readFds);
+    FD_ZERO(&writeFds);
+    FD_ZERO(&errorFds);
+    int maxFd = -1;
+    curl_multi_fdset(m_multi, &readFds, &writeFds, &errorFds, &maxFd);
+
+    // no sockets to wait on yet, for example while resolving
+    if (maxFd == -1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+        return;
+    }
+    timeval wait;
+    wait.tv_sec = timeout / 1000;
+    wait.tv_usec = (timeout % 1000) * 1000;
+    select(maxFd + 1, &readFds, &writeFds, &errorFds, &wait);
+}
+
+void WebClient::work() {
+    thread::setName(m_name);
+    while (true) {
+        this->startQueued();
+
+        int running = 0;
+        while (curl_multi_perform(m_multi, &running) == CURLM_CALL_MULTI_PERFORM);
+        this->finishDone();
+
+        if (!m_active.empty()) {
+            this->waitForActivity();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/cocos/platform/IncludeCurl.h>
+#include <Geode/utils/MiniFunction.hpp>
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * Runs every async web request on a single network thread through one curl 
+ * multi handle. Requests share its connection cache, so requests to the same 
+ * host reuse connections, and a DNS and TLS session cache. Only a limited amount
+ * of transfers run at once, the rest wait in the order they were queued
+ */
+class WebClient {
+public:
+    // called on the network thread once the transfer is done. the handle
+    // has already been removed from the client and may be cleaned up
+    using Completion = geode::utils::MoveOnlyMiniFunction<void(CURLcode)>;
+
+protected:
+    struct Transfer {
+        CURL* handle;
+        Completion done;
+    };
+
+    std::string m_name;
+    size_t m_maxTransfers;
+    CURLM* m_multi;
+    CURLSH* m_share;
+    // sync transfers use the share on their own threads
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> m_shareMutexes;
+
+    std::mutex m_mutex;
+    std::condition_variable m_queuedCV;
+    std::deque<Transfer> m_queued;
+    // only accessed on the network thread
+    std::unordered_map<CURL*, Completion> m_active;
+
+    void work();
+    void startQueued();
+    void finishDone();
+    void waitForActivity();
+
+public:
+    /**
+     * Create a client with its own network thread
+     * @param name Name given to the network thread
+     * @param maxTransfers Amount of transfers that may run at once
+     */
+    WebClient(std::string name, size_t maxTransfers);
+    WebClient(WebClient const&) = delete;
+    WebClient& operator=(WebClient const&) = delete;
+
+    /**
+     * Get the client used by utils::web
+     */
+    static WebClient* get();
+
+    /**
+     * Create an easy handle with the options every request uses
+     */
+    CURL* createHandle();
+
+    /**
+     * Queue a transfer. The client takes over the handle until done is
+     * called, so it may not be touched until then
+     */
+    void perform(CURL* handle, Completion done);
+
+    /**
+     * Run a transfer on the calling thread and block until it's done. It
+     * skips the queue, so it never waits behind async transfers, and still
+     * uses the shared DNS and TLS session cache, but not the connection
+     * cache of the network thread
+     */
+    CURLcode performSync(CURL* handle);
+};
@@ -2,6 +2,7 @@
 #include <fmt/core.h>
 #include "about.hpp"
 #include "../loader/ModImpl.hpp"
+#include "../loader/LogImpl.hpp"
 #include <Geode/Utils.hpp>
 
 using namespace geode::prelude;
@@ -53,6 +54,10 @@ void crashlog::printMods(std::stringstream& stream) {
 }
 
 std::string crashlog::writeCrashlog(geode::Mod* faultyMod, std::string const& info, std::string const& stacktrace, std::string const& registers) {
+    // get the logs leading up to the crash into the log file before 
+    // anything else has a chance to go wrong
+    log::Logger::get()->flush();
+
     // make sure crashlog directory exists
     (void)utils::file::createDirectoryAll(crashlog::getCrashLogDirectory());
 
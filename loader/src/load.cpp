@@ -18,6 +18,13 @@ using namespace geode::prelude;
 #include "load.hpp"
 
 $execute {
+    listenForSettingChanges<std::string>("log-level", +[](std::string) {
+        log::applyLevelSettings();
+    });
+    listenForSettingChanges<std::string>("mod-log-levels", +[](std::string) {
+        log::applyLevelSettings();
+    });
+
     ipc::listen("ipc-test", [](ipc::IPCEvent* event) -> matjson::Value {
         return "Hello from Geode!";
     });
@@ -141,6 +148,19 @@ int geodeEntry(void* platformData) {
 
     tryShowForwardCompat();
 
+    // before anything else gets logged, so the levels apply right away
+    log::applyLevelSettings();
+
+    if (Mod::get()->getSettingValue<bool>("binary-log")) {
+        auto res = log::Logger::get()->setupBinaryLog(
+            Mod::get()->getSettingValue<int64_t>("binary-log-segment-size") * 1024 * 1024,
+            Mod::get()->getSettingValue<int64_t>("binary-log-segment-count")
+        );
+        if (!res) {
+            log::warn("Unable to set up binary log: {}", res.unwrapErr());
+        }
+    }
+
     // open console
     if (!LoaderImpl::get()->isForwardCompatMode() &&
         Mod::get()->getSettingValue<bool>("show-platform-console")) {
@@ -170,6 +190,8 @@ int geodeEntry(void* platformData) {
     ipc::setup();
     log::popNest();
 
+    updater::removeLegacySavedValues();
+
     // download and install new loader update in the background
     if (Mod::get()->getSettingValue<bool>("auto-check-updates")) {
         log::info("Starting loader update check");
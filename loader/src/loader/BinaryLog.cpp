@@ -0,0 +1,212 @@
+#include "BinaryLog.hpp"
+#include "BinaryLogFormat.hpp"
+#include "ThreadPool.hpp"
+
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/string.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <zlib.h>
+
+using namespace geode::prelude;
+using namespace geode::log;
+
+template <class T>
+static void writeInt(std::string& buffer, T value) {
+    // every platform geode runs on is little-endian
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    buffer.append(bytes, sizeof(T));
+}
+
+static bool isSegment(ghc::filesystem::path const& path) {
+    auto name = path.filename().string();
+    return name.ends_with(binary::EXTENSION) || name.ends_with(binary::COMPRESSED_EXTENSION);
+}
+
+static Result<> compressSegment(ghc::filesystem::path const& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return Err("Unable to open segment");
+    }
+    auto outputPath = path;
+    outputPath += ".gz";
+#ifdef GEODE_IS_WINDOWS
+    auto output = gzopen_w(outputPath.wstring().c_str(), "wb");
+#else
+    auto output = gzopen(outputPath.string().c_str(), "wb");
+#endif
+    if (!output) {
+        return Err("Unable to create compressed segment");
+    }
+
+    char chunk[64 * 1024];
+    bool ok = true;
+    while (ok && input) {
+        input.read(chunk, sizeof(chunk));
+        auto count = static_cast<unsigned>(input.gcount());
+        if (count && gzwrite(output, chunk, count) != static_cast<int>(count)) {
+            ok = false;
+        }
+    }
+    ok = gzclose(output) == Z_OK && ok;
+    input.close();
+
+    std::error_code ec;
+    if (!ok) {
+        ghc::filesystem::remove(outputPath, ec);
+        return Err("Unable to write compressed segment");
+    }
+    ghc::filesystem::remove(path, ec);
+    return Ok();
+}
+
+Result<std::unique_ptr<BinaryLogSink>> BinaryLogSink::create(
+    ghc::filesystem::path const& dir, std::string const& sessionName,
+    size_t maxSegmentSize, size_t maxSegmentCount
+) {
+    GEODE_UNWRAP(file::createDirectoryAll(dir));
+
+    auto sink = std::unique_ptr<BinaryLogSink>(new BinaryLogSink());
+    sink->m_dir = dir;
+    sink->m_sessionName = sessionName;
+    sink->m_maxSegmentSize = maxSegmentSize;
+    sink->m_maxSegmentCount = std::max<size_t>(maxSegmentCount, 1);
+    GEODE_UNWRAP(sink->openSegment());
+    return Ok(std::move(sink));
+}
+
+Result<> BinaryLogSink::openSegment() {
+    m_segmentPath = m_dir / fmt::format("{} {:04}{}", m_sessionName, m_segmentIndex, binary::EXTENSION);
+    m_stream = std::ofstream(m_segmentPath, std::ios::binary);
+    if (!m_stream) {
+        return Err("Unable to open log segment {}", m_segmentPath.string());
+    }
+    m_sources.clear();
+    m_threads.clear();
+
+    m_buffer.append(binary::MAGIC, sizeof(binary::MAGIC));
+    writeInt<uint16_t>(m_buffer, binary::VERSION);
+    writeInt<uint16_t>(m_buffer, 0);
+    m_segmentSize = 0;
+
+    this->removeOldSegments();
+    return Ok();
+}
+
+void BinaryLogSink::rotate() {
+    this->flush();
+    m_stream.close();
+
+    // compressing a whole segment takes a while, and logging shouldn't 
+    // stall for it. the segment isn't touched by the sink after this
+    ThreadPool::get()->push([path = m_segmentPath]() {
+        auto res = compressSegment(path);
+        if (!res) {
+            // the uncompressed segment is still there and gets cleaned up like any other
+            log::warn("Unable to compress log segment {}: {}", path.string(), res.unwrapErr());
+        }
+    });
+
+    m_segmentIndex += 1;
+    (void)this->openSegment();
+}
+
+void BinaryLogSink::removeOldSegments() {
+    std::error_code ec;
+    // while a segment is being compressed both its .glog and .glog.gz exist, 
+    // so files are grouped by the segment they belong to. segment names 
+    // start with the time their session started, so this is also sorted 
+    // from oldest to newest
+    std::map<std::string, std::vector<ghc::filesystem::path>> segments;
+    for (auto& entry : ghc::filesystem::directory_iterator(m_dir, ec)) {
+        if (entry.is_regular_file(ec) && isSegment(entry.path())) {
+            auto name = entry.path().filename().string();
+            if (name.ends_with(binary::COMPRESSED_EXTENSION)) {
+                name.resize(name.size() - binary::COMPRESSED_EXTENSION.size() + binary::EXTENSION.size());
+            }
+            segments[name].push_back(entry.path());
+        }
+    }
+    if (segments.size() <= m_maxSegmentCount) {
+        return;
+    }
+    auto toRemove = segments.size() - m_maxSegmentCount;
+    auto current = m_segmentPath.filename().string();
+    for (auto& [name, files] : segments) {
+        if (toRemove == 0) {
+            break;
+        }
+        toRemove -= 1;
+        if (name == current) {
+            continue;
+        }
+        for (auto& file : files) {
+            ghc::filesystem::remove(file, ec);
+        }
+    }
+}
+
+uint16_t BinaryLogSink::getNameIndex(
+    std::unordered_map<std::string, uint16_t>& names, uint8_t recordType,
+    std::string const& name
+) {
+    auto it = names.find(name);
+    if (it != names.end()) {
+        return it->second;
+    }
+    auto index = static_cast<uint16_t>(names.size());
+    auto length = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    names.insert({ name, index });
+
+    writeInt<uint8_t>(m_buffer, recordType);
+    writeInt<uint16_t>(m_buffer, index);
+    writeInt<uint16_t>(m_buffer, length);
+    m_buffer.append(name.data(), length);
+    return index;
+}
+
+void BinaryLogSink::write(Log const& log) {
+    if (!m_stream) {
+        return;
+    }
+    // indices are only 16 bits, so start over in a new segment if they run out
+    if (m_sources.size() >= UINT16_MAX || m_threads.size() >= UINT16_MAX) {
+        this->rotate();
+    }
+
+    auto thread = this->getNameIndex(
+        m_threads, static_cast<uint8_t>(binary::RecordType::Thread), log.getThread()
+    );
+    auto source = this->getNameIndex(
+        m_sources, static_cast<uint8_t>(binary::RecordType::Source), log.getSource()
+    );
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+        log.getTime().time_since_epoch()
+    ).count();
+    auto& content = log.getContent();
+
+    writeInt<uint8_t>(m_buffer, static_cast<uint8_t>(binary::RecordType::Log));
+    writeInt<uint64_t>(m_buffer, static_cast<uint64_t>(time));
+    writeInt<uint16_t>(m_buffer, thread);
+    writeInt<uint16_t>(m_buffer, source);
+    writeInt<uint8_t>(m_buffer, static_cast<uint8_t>(log.getSeverity().m_value));
+    writeInt<uint32_t>(m_buffer, static_cast<uint32_t>(content.size()));
+    m_buffer += content;
+
+    if (m_segmentSize + m_buffer.size() >= m_maxSegmentSize) {
+        this->rotate();
+    }
+}
+
+void BinaryLogSink::flush() {
+    if (m_buffer.empty()) {
+        return;
+    }
+    m_stream.write(m_buffer.data(), m_buffer.size());
+    m_stream.flush();
+    m_segmentSize += m_buffer.size();
+    m_buffer.clear();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "LogImpl.hpp"
+
+#include <Geode/utils/Result.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace geode::log {
+    /**
+     * Writes logs in the compact format described in BinaryLogFormat.hpp.
+     * Segments are rotated once they grow past a size limit, rotated out
+     * segments are compressed on the loader's thread pool, and only the newest few segments are kept
+     * across sessions. Not thread-safe, only used by the log writer
+     */
+    class BinaryLogSink final {
+    private:
+        ghc::filesystem::path m_dir;
+        std::string m_sessionName;
+        size_t m_maxSegmentSize;
+        size_t m_maxSegmentCount;
+
+        std::ofstream m_stream;
+        ghc::filesystem::path m_segmentPath;
+        size_t m_segmentIndex = 0;
+        size_t m_segmentSize = 0;
+        // indices of the sources and threads named in the current segment
+        std::unordered_map<std::string, uint16_t> m_sources;
+        std::unordered_map<std::string, uint16_t> m_threads;
+        std::string m_buffer;
+
+        BinaryLogSink() = default;
+
+        Result<> openSegment();
+        void rotate();
+        void removeOldSegments();
+        uint16_t getNameIndex(
+            std::unordered_map<std::string, uint16_t>& names, uint8_t recordType,
+            std::string const& name
+        );
+
+    public:
+        /**
+         * Start writing a new segment
+         * @param dir Directory the segments are placed in
+         * @param sessionName Prefix for this session's segments. Segment
+         * names have to sort in the order they were written in
+         * @param maxSegmentSize Segment size in bytes after which a new
+         * segment is started
+         * @param maxSegmentCount Amount of segments kept, including ones from
+         * previous sessions
+         */
+        static Result<std::unique_ptr<BinaryLogSink>> create(
+            ghc::filesystem::path const& dir, std::string const& sessionName,
+            size_t maxSegmentSize, size_t maxSegmentCount
+        );
+
+        void write(Log const& log);
+        void flush();
+    };
+}
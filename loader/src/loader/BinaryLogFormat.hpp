@@ -0,0 +1,36 @@
+#pragma once
+
+// Shared between the loader and the log decoder tool, so this may only
+// depend on the standard library
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Binary logs are split into segments, each of which can be decoded on its
+ * own. A segment starts with a header, followed by records that all start
+ * with their RecordType. All integers are little-endian.
+ *
+ * Header: char[4] magic, u16 version, u16 reserved
+ * Source: u16 index, u16 length, char[length] name
+ * Thread: u16 index, u16 length, char[length] name
+ * Log:    u64 time, u16 thread, u16 source, u8 severity, u32 length,
+ *         char[length] content
+ *
+ * Source and thread records name the indices that logs after them refer to.
+ * Log times are microseconds since the unix epoch
+ */
+namespace geode::log::binary {
+    constexpr char MAGIC[4] = { 'G', 'L', 'O', 'G' };
+    constexpr uint16_t VERSION = 1;
+
+    constexpr std::string_view EXTENSION = ".glog";
+    // extension of segments after they've been compressed with gzip
+    constexpr std::string_view COMPRESSED_EXTENSION = ".glog.gz";
+
+    enum class RecordType : uint8_t {
+        Source = 1,
+        Thread = 2,
+        Log = 3,
+    };
+}
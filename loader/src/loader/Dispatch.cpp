@@ -5,4 +5,11 @@ using namespace geode::prelude;
 std::unordered_map<std::string, EventListenerPool*>& geode::dispatchPools() {
     static std::unordered_map<std::string, EventListenerPool*> pools;
     return pools;
-}
\ No newline at end of file
+}
+EventListenerPool* geode::getDispatchPool(std::string const& id) {
+    auto& pool = dispatchPools()[id];
+    if (!pool) {
+        pool = new DefaultEventListenerPool();
+    }
+    return pool;
+}
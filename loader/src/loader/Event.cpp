@@ -1,49 +1,234 @@
 #include <Geode/loader/Event.hpp>
 #include <Geode/utils/ranges.hpp>
+#include <algorithm>
 #include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
 
 using namespace geode::prelude;
 
+size_t geode::getEventTypeID(std::type_info const& type) {
+    static std::mutex mutex;
+    // type_info objects aren't guaranteed to be unique across modules, so
+    // IDs are assigned by name and the address is only a shortcut
+    static std::unordered_map<std::type_info const*, size_t> byInfo;
+    static std::unordered_map<std::string, size_t> byName;
+
+    std::lock_guard lock(mutex);
+    if (auto it = byInfo.find(&type); it != byInfo.end()) {
+        return it->second;
+    }
+    // 0 is reserved for listeners that accept any event
+    auto id = byName.try_emplace(type.name(), byName.size() + 1).first->second;
+    byInfo.insert({ &type, id });
+    return id;
+}
+
 bool DefaultEventListenerPool::add(EventListenerProtocol* listener) {
+    auto typeID = listener->getEventTypeID();
+    auto [it, created] = m_shards.try_emplace(typeID);
+    auto& shard = it->second;
+    if (created) {
+        shard.matcher = typeID ? listener->getEventTypeMatcher() : nullptr;
+        // the shard may have to be visited by events that were already cached
+        if (m_locked) {
+            m_matchingShardsStale = true;
+        }
+        else {
+            m_matchingShards.clear();
+        }
+    }
+    auto key = listener->getFilterKey();
+    auto& entries = key ? shard.keyed[*key] : shard.entries;
+    // listeners added while handling an event don't get that event, which is
+    // guaranteed by handle only visiting the entries that existed beforehand
+    entries.push_back({ listener, m_nextOrder++ });
+    m_listenerEntries[listener] = &entries;
+    return true;
+}
+
+void DefaultEventListenerPool::remove(EventListenerProtocol* listener) {
+    auto it = m_listenerEntries.find(listener);
+    if (it == m_listenerEntries.end()) {
+        return;
+    }
+    auto entries = it->second;
+    m_listenerEntries.erase(it);
+    std::erase(m_pendingRekeys, listener);
+
     if (m_locked) {
-        m_toAdd.push_back(listener);
+        // if an event listener gets destroyed in the middle of handling, it 
+        // gets set to null and removed afterwards
+        for (auto& entry : *entries) {
+            if (entry.listener == listener) {
+                entry.listener = nullptr;
+            }
+        }
+        m_dirtyEntries.insert(entries);
     }
     else {
-        // insert listeners at the start so new listeners get priority
-        m_listeners.insert(m_listeners.begin(), listener);
+        std::erase_if(*entries, [&](auto const& entry) {
+            return entry.listener == listener;
+        });
     }
-    return true;
 }
 
-void DefaultEventListenerPool::remove(EventListenerProtocol* listener) {
-    for (size_t i = 0; i < m_listeners.size(); i++) {
-        if (m_listeners[i] == listener) {
-            m_listeners[i] = nullptr;
+void DefaultEventListenerPool::rekey(EventListenerProtocol* listener) {
+    auto it = m_listenerEntries.find(listener);
+    if (it == m_listenerEntries.end()) {
+        return;
+    }
+    // the lists can't be reordered while they're being iterated, so this 
+    // waits until the event is done. the listener still checks its filter 
+    // in the meantime, it may just miss events for its new key
+    if (m_locked) {
+        m_pendingRekeys.push_back(listener);
+        return;
+    }
+
+    auto& shard = m_shards.at(listener->getEventTypeID());
+    auto key = listener->getFilterKey();
+    auto& target = key ? shard.keyed[*key] : shard.entries;
+    auto from = it->second;
+    if (from == &target) {
+        return;
+    }
+    auto entry = std::find_if(from->begin(), from->end(), [&](auto const& entry) {
+        return entry.listener == listener;
+    });
+    if (entry == from->end()) {
+        return;
+    }
+    auto order = entry->order;
+    from->erase(entry);
+
+    // lists are sorted by order, so insert where it would have been added
+    auto pos = std::upper_bound(target.begin(), target.end(), order, [](size_t order, Entry const& entry) {
+        return order < entry.order;
+    });
+    target.insert(pos, { listener, order });
+    it->second = &target;
+}
+
+std::vector<DefaultEventListenerPool::Shard*> const& DefaultEventListenerPool::getMatchingShards(
+    Event* event
+) {
+    auto& type = typeid(*event);
+    auto [it, created] = m_matchingShards.try_emplace(&type);
+    if (created) {
+        // only happens once per event class (and after new listener classes
+        // show up), so doing the ID lookup and RTTI checks here is fine
+        auto typeID = getEventTypeID(type);
+        for (auto& [id, shard] : m_shards) {
+            if (id == 0 || id == typeID || (shard.matcher && shard.matcher(event))) {
+                it->second.push_back(&shard);
+            }
         }
     }
-    ranges::remove(m_toAdd, listener);
+    return it->second;
+}
+
+void DefaultEventListenerPool::cleanUp() {
+    for (auto entries : m_dirtyEntries) {
+        std::erase_if(*entries, [](auto const& entry) {
+            return entry.listener == nullptr;
+        });
+    }
+    m_dirtyEntries.clear();
+    for (auto listener : std::exchange(m_pendingRekeys, {})) {
+        this->rekey(listener);
+    }
+    if (m_matchingShardsStale) {
+        m_matchingShards.clear();
+        m_matchingShardsStale = false;
+    }
 }
 
 ListenerResult DefaultEventListenerPool::handle(Event* event) {
     auto res = ListenerResult::Propagate;
+    auto& shards = this->getMatchingShards(event);
+    auto key = event->getFilterKey();
+
+    // collect the lists of listeners that may be interested in this event. 
+    // usually that's just one, in which case nothing needs to be allocated
+    Entries* single = nullptr;
+    std::vector<Entries*> lists;
+    auto collect = [&](Entries& entries) {
+        if (entries.empty()) return;
+        if (!single && lists.empty()) {
+            single = &entries;
+            return;
+        }
+        if (single) {
+            lists.push_back(std::exchange(single, nullptr));
+        }
+        lists.push_back(&entries);
+    };
+    for (auto shard : shards) {
+        collect(shard->entries);
+        if (key) {
+            if (auto it = shard->keyed.find(*key); it != shard->keyed.end()) {
+                collect(it->second);
+            }
+        }
+        else {
+            for (auto& [_, entries] : shard->keyed) {
+                collect(entries);
+            }
+        }
+    }
+
     m_locked += 1;
-    for (auto h : m_listeners) {
-        // if an event listener gets destroyed in the middle of this loop, it 
-        // gets set to null
-        if (h && h->handle(event) == ListenerResult::Stop) {
-            res = ListenerResult::Stop;
-            break;
+
+    // if an event listener gets destroyed in the middle of these loops, it 
+    // gets set to null. entries are accessed by index since listeners may be 
+    // added to the lists while handling
+    if (single) {
+        for (size_t i = single->size(); i > 0; i--) {
+            auto h = (*single)[i - 1].listener;
+            if (h && h->handle(event) == ListenerResult::Stop) {
+                res = ListenerResult::Stop;
+                break;
+            }
         }
     }
+    else if (lists.size()) {
+        // merge the lists to keep the newest listeners first
+        std::vector<size_t> cursors;
+        cursors.reserve(lists.size());
+        for (auto entries : lists) {
+            cursors.push_back(entries->size());
+        }
+        while (true) {
+            Entry* next = nullptr;
+            size_t nextList = 0;
+            for (size_t l = 0; l < lists.size(); l++) {
+                if (cursors[l] == 0) continue;
+                auto& entry = (*lists[l])[cursors[l] - 1];
+                if (!next || entry.order > next->order) {
+                    next = &entry;
+                    nextList = l;
+                }
+            }
+            if (!next) {
+                break;
+            }
+            cursors[nextList] -= 1;
+            auto h = next->listener;
+            if (h && h->handle(event) == ListenerResult::Stop) {
+                res = ListenerResult::Stop;
+                break;
+            }
+        }
+    }
+
     m_locked -= 1;
     // only mutate listeners once nothing is iterating 
     // (if there are recursive handle calls)
     if (m_locked == 0) {
-        ranges::remove(m_listeners, nullptr);
-        for (auto listener : m_toAdd) {
-            m_listeners.insert(m_listeners.begin(), listener);
-        }
-        m_toAdd.clear();
+        this->cleanUp();
     }
     return res;
 }
@@ -57,6 +242,29 @@ EventListenerPool* EventListenerProtocol::getPool() const {
     return DefaultEventListenerPool::get();
 }
 
+size_t EventListenerProtocol::getEventTypeID() const {
+    return 0;
+}
+
+EventTypeMatcher EventListenerProtocol::getEventTypeMatcher() const {
+    return nullptr;
+}
+
+std::optional<size_t> EventListenerProtocol::getFilterKey() const {
+    return std::nullopt;
+}
+
+void EventListenerPool::rekey(EventListenerProtocol* listener) {
+    this->remove(listener);
+    this->add(listener);
+}
+
+void EventListenerProtocol::updateFilterKey() {
+    if (m_pool) {
+        m_pool->rekey(this);
+    }
+}
+
 bool EventListenerProtocol::enable() {
     // virtual calls from destructors always call the base class so we gotta 
     // store the subclass' pool in a member to be able to access it in disable
@@ -69,6 +277,10 @@ bool EventListenerProtocol::enable() {
     return m_pool->add(this);
 }
 
+bool EventListenerProtocol::isEnabled() const {
+    return m_pool != nullptr;
+}
+
 void EventListenerProtocol::disable() {
     if (m_pool) {
         m_pool->remove(this);
@@ -82,6 +294,10 @@ EventListenerProtocol::~EventListenerProtocol() {
 
 Event::~Event() {}
 
+std::optional<size_t> Event::getFilterKey() const {
+    return std::nullopt;
+}
+
 EventListenerPool* Event::getPool() const {
     return DefaultEventListenerPool::get();
 }
@@ -8,6 +8,9 @@
 #include <hash/hash.hpp>
 #include <Geode/utils/JsonValidation.hpp>
 #include <Geode/loader/Mod.hpp>
+#include "IndexSnapshot.hpp"
+#include "ModMetadataImpl.hpp"
+#include "ThreadPool.hpp"
 
 #include <thread>
 
@@ -48,11 +51,53 @@ IndexUpdateFilter::IndexUpdateFilter() {}
 
 // IndexItem
 
+// TODO: gross hack :3 (ctrl+f this comment to find the other part)
+extern thread_local bool s_jsonCheckerShouldCheckUnknownKeys;
+
+// bit used for platforms this version of the loader doesn't know about
+static constexpr uint32_t UNKNOWN_PLATFORM_BIT = 1u << 31;
+
+static uint32_t packPlatforms(std::unordered_set<PlatformID> const& platforms) {
+    uint32_t res = 0;
+    for (auto& platform : platforms) {
+        res |= platform == PlatformID::Unknown ? UNKNOWN_PLATFORM_BIT : (1u << platform.m_value);
+    }
+    return res;
+}
+
+static std::unordered_set<PlatformID> unpackPlatforms(uint32_t platforms) {
+    std::unordered_set<PlatformID> res;
+    for (int i = 0; i < 31; i++) {
+        if (platforms & (1u << i)) {
+            res.insert(PlatformID(static_cast<PlatformID::Type>(i)));
+        }
+    }
+    if (platforms & UNKNOWN_PLATFORM_BIT) {
+        res.insert(PlatformID::Unknown);
+    }
+    return res;
+}
+
 class IndexItem::Impl final {
 private:
     ghc::filesystem::path m_rootPath;
     ghc::filesystem::path m_path;
-    ModMetadata m_metadata;
+    // known without parsing the metadata
+    std::string m_id;
+    VersionInfo m_version;
+    std::string m_name;
+    std::optional<std::string> m_description;
+    // items from the index snapshot only parse their mod.json once it's 
+    // first needed, and about.md and changelog.md are only read when asked 
+    // for with loadSpecialFiles
+    mutable std::mutex m_metadataMutex;
+    mutable std::optional<ModMetadata> m_metadata;
+    mutable std::shared_ptr<IndexSnapshot> m_snapshot;
+    std::string_view m_metadataSource;
+    bool m_specialFilesLoaded = false;
+    // read up front, since searching needs it for every item
+    std::optional<std::string> m_details;
+    std::vector<std::string> m_developers;
     std::string m_downloadURL;
     std::string m_downloadHash;
     std::unordered_set<PlatformID> m_platforms;
@@ -61,6 +106,9 @@ private:
     std::unordered_set<std::string> m_tags;
 
     friend class IndexItem;
+    friend class Index;
+
+    ModMetadata parseMetadata() const;
 
 public:
     /**
@@ -70,7 +118,19 @@ public:
         ghc::filesystem::path const& rootDir,
         ghc::filesystem::path const& dir
     );
+    /**
+     * Create IndexItem from an item in the index snapshot. The snapshot is 
+     * kept open until the item's metadata has been parsed
+     */
+    static std::shared_ptr<IndexItem> create(
+        ghc::filesystem::path const& rootDir,
+        VersionInfo const& version,
+        std::shared_ptr<IndexSnapshot> const& snapshot,
+        size_t index
+    );
 
+    ModMetadata getMetadata() const;
+    Result<> loadSpecialFiles();
     bool isInstalled() const;
 };
 
@@ -86,7 +146,31 @@ ghc::filesystem::path IndexItem::getPath() const {
 }
 
 ModMetadata IndexItem::getMetadata() const {
-    return m_impl->m_metadata;
+    return m_impl->getMetadata();
+}
+
+Result<> IndexItem::loadSpecialFiles() {
+    return m_impl->loadSpecialFiles();
+}
+
+std::string IndexItem::getID() const {
+    return m_impl->m_id;
+}
+
+std::string IndexItem::getName() const {
+    return m_impl->m_name;
+}
+
+std::optional<std::string> IndexItem::getDescription() const {
+    return m_impl->m_description;
+}
+
+std::vector<std::string> IndexItem::getDevelopers() const {
+    return m_impl->m_developers;
+}
+
+std::optional<std::string> IndexItem::getDetails() const {
+    return m_impl->m_details;
 }
 
 std::string IndexItem::getDownloadURL() const {
@@ -115,7 +199,14 @@ bool IndexItem::isInstalled() const {
 
 #if defined(GEODE_EXPOSE_SECRET_INTERNALS_IN_HEADERS_DO_NOT_DEFINE_PLEASE)
 void IndexItem::setMetadata(ModMetadata const& value) {
+    std::lock_guard lock(m_impl->m_metadataMutex);
+    m_impl->m_id = value.getID();
+    m_impl->m_version = value.getVersion();
+    m_impl->m_name = value.getName();
+    m_impl->m_description = value.getDescription();
+    m_impl->m_developers = value.getDevelopers();
     m_impl->m_metadata = value;
+    m_impl->m_snapshot = nullptr;
 }
 
 void IndexItem::setDownloadURL(std::string const& value) {
@@ -143,19 +234,37 @@ void IndexItem::setIsInstalled(bool const& value) {
 }
 #endif
 
+// like with loadSpecialFiles, the about.md shared between versions takes 
+// precedence
+static std::optional<std::string> readDetails(ghc::filesystem::path const& rootDir, ghc::filesystem::path const& dir) {
+    for (auto& path : { rootDir / "about.md", dir / "about.md" }) {
+        if (!ghc::filesystem::exists(path)) {
+            continue;
+        }
+        auto data = file::readString(path);
+        if (!data) {
+            log::warn("Unable to read {}: {}", path, data.unwrapErr());
+            continue;
+        }
+        return utils::string::replace(data.unwrap(), "\r", "");
+    }
+    return std::nullopt;
+}
+
 Result<IndexItemHandle> IndexItem::Impl::create(ghc::filesystem::path const& rootDir, ghc::filesystem::path const& dir) {
     GEODE_UNWRAP_INTO(
         auto entry, file::readJson(dir / "entry.json")
             .expect("Unable to read entry.json")
     );
     GEODE_UNWRAP_INTO(
-        auto metadata, ModMetadata::createFromFile(dir / "mod.json")
+        auto modJson, file::readJson(dir / "mod.json")
             .expect("Unable to read mod.json: {error}")
     );
-    auto metadataRes = metadata.addSpecialFiles(rootDir);
-    if (!metadataRes) {
-        log::warn("Unable to add special files from {}: {}", rootDir, metadataRes.unwrapErr());
-    }
+    GEODE_UNWRAP_INTO(
+        auto metadata, ModMetadata::create(modJson)
+            .expect("Unable to read mod.json: {error}")
+    );
+    ModMetadataImpl::getImpl(metadata).m_path = dir / "mod.json";
 
     JsonChecker checker(entry);
     auto checkerRoot = fmt::format("[{}/{}/entry.json]", metadata.getID(), metadata.getVersion());
@@ -174,7 +283,13 @@ Result<IndexItemHandle> IndexItem::Impl::create(ghc::filesystem::path const& roo
     auto item = std::make_shared<IndexItem>();
     item->m_impl->m_rootPath = rootDir;
     item->m_impl->m_path = dir;
+    item->m_impl->m_id = metadata.getID();
+    item->m_impl->m_version = metadata.getVersion();
+    item->m_impl->m_name = metadata.getName();
+    item->m_impl->m_description = metadata.getDescription();
+    item->m_impl->m_developers = metadata.getDevelopers();
     item->m_impl->m_metadata = metadata;
+    item->m_impl->m_details = readDetails(rootDir, dir);
     item->m_impl->m_platforms = platforms;
     item->m_impl->m_tags = tags;
     root.has("mod").obj().has("download").into(item->m_impl->m_downloadURL);
@@ -187,15 +302,93 @@ Result<IndexItemHandle> IndexItem::Impl::create(ghc::filesystem::path const& roo
     return Ok(item);
 }
 
+IndexItemHandle IndexItem::Impl::create(
+    ghc::filesystem::path const& rootDir,
+    VersionInfo const& version,
+    std::shared_ptr<IndexSnapshot> const& snapshot,
+    size_t index
+) {
+    auto record = snapshot->getItem(index);
+
+    auto item = std::make_shared<IndexItem>();
+    item->m_impl->m_rootPath = rootDir;
+    item->m_impl->m_path = rootDir / record.directory;
+    // the mod's directory is named after its ID
+    item->m_impl->m_id = rootDir.filename().string();
+    item->m_impl->m_version = version;
+    item->m_impl->m_name = record.name;
+    if (!record.description.empty()) {
+        item->m_impl->m_description = std::string(record.description);
+    }
+    item->m_impl->m_snapshot = snapshot;
+    item->m_impl->m_metadataSource = record.modJson;
+    if (!record.details.empty()) {
+        item->m_impl->m_details = std::string(record.details);
+    }
+    item->m_impl->m_developers.assign(record.developers.begin(), record.developers.end());
+    item->m_impl->m_downloadURL = record.downloadURL;
+    item->m_impl->m_downloadHash = record.packageHash;
+    item->m_impl->m_platforms = unpackPlatforms(record.platforms);
+    item->m_impl->m_isFeatured = record.featured;
+    item->m_impl->m_tags.insert(record.tags.begin(), record.tags.end());
+    return item;
+}
+
+ModMetadata IndexItem::Impl::parseMetadata() const {
+    std::string error;
+    auto json = matjson::parse(std::string(m_metadataSource), error);
+    if (error.size() > 0) {
+        log::error("Unable to parse mod.json of {} from the index snapshot: {}", m_path, error);
+        return ModMetadata(m_id);
+    }
+    // this mod.json was already checked when the snapshot was compiled
+    s_jsonCheckerShouldCheckUnknownKeys = false;
+    auto res = ModMetadata::create(json.value());
+    s_jsonCheckerShouldCheckUnknownKeys = true;
+    if (!res) {
+        log::error("Unable to read mod.json of {} from the index snapshot: {}", m_path, res.unwrapErr());
+        return ModMetadata(m_id);
+    }
+    auto metadata = res.unwrap();
+    ModMetadataImpl::getImpl(metadata).m_path = m_path / "mod.json";
+    return metadata;
+}
+
+ModMetadata IndexItem::Impl::getMetadata() const {
+    std::lock_guard lock(m_metadataMutex);
+    if (!m_metadata) {
+        m_metadata = this->parseMetadata();
+        // the snapshot can be unmapped once nothing needs it anymore
+        m_snapshot = nullptr;
+    }
+    return *m_metadata;
+}
+
+Result<> IndexItem::Impl::loadSpecialFiles() {
+    // make sure the metadata has been parsed
+    (void)this->getMetadata();
+
+    std::lock_guard lock(m_metadataMutex);
+    if (m_specialFilesLoaded) {
+        return Ok();
+    }
+    m_specialFilesLoaded = true;
+    auto& impl = ModMetadataImpl::getImpl(*m_metadata);
+    GEODE_UNWRAP(impl.addSpecialFiles(m_path));
+    // files shared between versions take precedence
+    GEODE_UNWRAP(impl.addSpecialFiles(m_rootPath));
+    return Ok();
+}
+
 bool IndexItem::Impl::isInstalled() const {
     if (m_isInstalled) {
         return true;
     }
-    if (!Loader::get()->isModInstalled(m_metadata.getID())) {
+    if (!Loader::get()->isModInstalled(m_id)) {
         return false;
     }
-    auto installed = Loader::get()->getInstalledMod(m_metadata.getID());
-    if (installed->getVersion() != m_metadata.getVersion()) {
+    auto installed = Loader::get()->getInstalledMod(m_id);
+    if (installed->getVersion() != m_version) {
         return false;
     }
     return true;
@@ -203,39 +396,24 @@ bool IndexItem::Impl::isInstalled() const {
 
 // Helpers
 
-static Result<> flattenGithubRepo(ghc::filesystem::path const& dir) {
-    // github zipballs have a folder at root, but we already have our 
-    // own folder for that so let's just bring everything from that 
-    // folder to ours
-    GEODE_UNWRAP_INTO(auto files, file::readDirectory(dir));
-    std::error_code ec;
-    // only flatten if there is only one file and it's a directory
-    if (files.size() == 1 && ghc::filesystem::is_directory(files[0], ec)) {
-        for (auto& file : ghc::filesystem::directory_iterator(files[0])) {
-            #ifdef GEODE_IS_WINDOWS
-            ghc::filesystem::path const relative = std::filesystem::relative(file.path().wstring(), files[0].wstring(), ec).wstring();
-            #else
-            auto const relative = ghc::filesystem::relative(file, files[0], ec);
-            #endif
-            if (ec) {
-                return Err(fmt::format("Unable to get relative path: {}", ec.message()));
-            }
-            ghc::filesystem::rename(
-                file, dir / relative, ec
-            );
-            if (ec) {
-                return Err(fmt::format("Unable to move file: {}", ec.message()));
-            }
+// github zipballs have everything in a folder named after the repo and 
+// commit, which we skip since we already have our own folder for that
+static ghc::filesystem::path getZipballRoot(file::Unzip const& unzip) {
+    ghc::filesystem::path root;
+    for (auto& entry : unzip.getEntries()) {
+        if (entry.empty()) {
+            continue;
         }
-        ghc::filesystem::remove(files[0], ec);
-        if (ec) {
-            return Err(fmt::format("Unable to remove directory: {}", ec.message()));
+        auto first = *entry.begin();
+        if (root.empty()) {
+            root = first;
+        }
+        else if (root != first) {
+            log::warn("Unable to flatten github repo: {}", unzip.getPath());
+            return ghc::filesystem::path();
         }
     }
-    else {
-        log::warn("Unable to flatten github repo: {}", dir);
-    }
-    return Ok();
+    return root;
 }
 
 // Index impl
@@ -263,6 +441,9 @@ private:
     void downloadIndex(std::string commitHash = "");
     void checkForUpdates();
     void updateFromLocalTree();
+    bool loadSnapshot(std::string const& revision);
+    void saveSnapshot(std::string const& revision);
+    bool loadLocalTree();
     void installNext(size_t index, IndexInstallList const& list);
 
 public:
@@ -325,43 +506,42 @@ void Index::Impl::downloadIndex(std::string commitHash) {
                 thread::setName("Index Update");
 
                 auto targetDir = dirs::getIndexDir() / "v0";
-                // delete old unzipped index
+
+                // the snapshot would no longer match the tree
                 std::error_code ec;
-                if (ghc::filesystem::exists(targetDir, ec)) {
-                    ghc::filesystem::remove_all(targetDir, ec);
-                    if (ec) {
-                        IndexUpdateEvent(UpdateFailed(fmt::format("Unable to clear cached index: {}", ec.message()))).post();
-                        return;
-                    }
+                ghc::filesystem::remove(dirs::getIndexDir() / IndexSnapshot::FILE_NAME, ec);
+                if (commitHash.empty()) {
+                    ghc::filesystem::remove(dirs::getIndexDir() / ".checksum", ec);
                 }
 
-                // unzip new index
+                // unzip new index, only extracting the files that changed 
+                // since the last update
                 log::debug("Unzipping index");
                 uint32_t nextPercent = 1;
-                auto unzip = file::Unzip::intoDir(
-                    [&](uint32_t current, uint32_t total) {
+                auto unzip = [&]() -> Result<> {
+                    GEODE_UNWRAP_INTO(auto unzip, file::Unzip::create(targetFile));
+                    unzip.setProgressCallback([&](uint32_t current, uint32_t total) {
                         if (total == 0) return;
 
                         if (static_cast<float>(current) / total * 100 >= nextPercent) {
                             Loader::get()->queueInMainThread([nextPercent]() {
                                 IndexUpdateEvent(UpdateProgress(nextPercent, "Extracting")).post();
-                            });
+                            }, Loader::TaskPriority::Background);
                             nextPercent++;
                         }
-                    },
-                    targetFile, targetDir, true
-                ).expect("Unable to unzip new index");
+                    });
+                    return unzip.updateDirectory(targetDir, getZipballRoot(unzip));
+                }().expect("Unable to unzip new index");
+                ghc::filesystem::remove(targetFile, ec);
                 if (!unzip) {
                     auto const err = unzip.unwrapErr();
                     log::error("Failed to unzip latest index: {}", err);
                     Loader::get()->queueInMainThread([err] {
                         IndexUpdateEvent(UpdateFailed(err)).post();
-                    });
+                    }, Loader::TaskPriority::Background);
                     return;
                 }
 
-                // remove the directory github adds to the root of the zip
-                (void)flattenGithubRepo(targetDir);
                 if (!commitHash.empty()) {
                     auto const checksumPath = dirs::getIndexDir() / ".checksum";
                     (void)file::writeString(checksumPath, commitHash);
@@ -439,64 +619,169 @@ void Index::Impl::checkForUpdates() {
         });
 }
 
-// TODO: gross hack :3 (ctrl+f this comment to find the other part)
-extern bool s_jsonCheckerShouldCheckUnknownKeys;
-void Index::Impl::updateFromLocalTree() {
-    log::debug("Updating local index cache");
-    log::pushNest();
-    std::unique_lock<std::mutex> lock(m_itemsMutex);
+bool Index::Impl::loadSnapshot(std::string const& revision) {
+    auto entriesRoot = dirs::getIndexDir() / "v0" / "mods-v2";
+    auto path = dirs::getIndexDir() / IndexSnapshot::FILE_NAME;
+    if (revision.empty() || !ghc::filesystem::exists(path)) {
+        return false;
+    }
+    auto res = IndexSnapshot::open(path);
+    if (!res) {
+        log::warn("Unable to open index snapshot: {}", res.unwrapErr());
+        return false;
+    }
+    auto snapshot = res.unwrap();
+    if (snapshot->getRevision() != revision) {
+        log::debug("Index snapshot is outdated");
+        return false;
+    }
 
-    Loader::get()->queueInMainThread([](){
-        IndexUpdateEvent(UpdateProgress(100, "Updating local cache")).post();
-    });
-    // delete old items
-    m_items.clear();
-    lock.unlock();
+    std::unordered_map<std::string, ItemVersions> items;
+    for (size_t i = 0; i < snapshot->getModCount(); i++) {
+        auto mod = snapshot->getMod(i);
+        auto rootDir = entriesRoot / mod.id;
+        auto& versions = items[std::string(mod.id)];
+        for (size_t j = mod.firstItem; j < mod.firstItem + mod.itemCount; j++) {
+            auto version = VersionInfo::parse(std::string(snapshot->getItem(j).version));
+            if (!version) {
+                continue;
+            }
+            versions.insert({ version.unwrap(), IndexItem::Impl::create(rootDir, version.unwrap(), snapshot, j) });
+        }
+    }
 
+    std::scoped_lock lock(m_itemsMutex);
+    m_items = std::move(items);
+    log::debug("Loaded {} items from index snapshot", snapshot->getItemCount());
+    return true;
+}
+
+void Index::Impl::saveSnapshot(std::string const& revision) {
+    if (revision.empty()) {
+        return;
+    }
+    IndexSnapshot::Builder builder;
+    {
+        std::scoped_lock lock(m_itemsMutex);
+        for (auto& [modID, versions] : m_items) {
+            builder.addMod(modID);
+            for (auto& [version, item] : versions) {
+                auto metadata = item->getMetadata();
+                builder.addItem(
+                    version.toString(),
+                    item->getName(),
+                    item->getDescription().value_or(""),
+                    item->getPath().filename().string(),
+                    metadata.getRawJSON().dump(matjson::NO_INDENTATION),
+                    item->getDownloadURL(),
+                    item->getPackageHash(),
+                    item->getDetails().value_or(""),
+                    packPlatforms(item->getAvailablePlatforms()),
+                    item->isFeatured(),
+                    std::vector<std::string>(item->m_impl->m_tags.begin(), item->m_impl->m_tags.end()),
+                    item->m_impl->m_developers
+                );
+            }
+        }
+    }
+    auto res = file::writeStringSafe(dirs::getIndexDir() / IndexSnapshot::FILE_NAME, builder.build(revision));
+    if (!res) {
+        log::warn("Unable to save index snapshot: {}", res.unwrapErr());
+    }
+}
+
+bool Index::Impl::loadLocalTree() {
     auto indexRoot = dirs::getIndexDir() / "v0";
     auto entriesRoot = indexRoot / "mods-v2";
 
     auto configRes = file::readJson(indexRoot / "config.json");
     if (!configRes) {
         IndexUpdateEvent("Unable to read index config").post();
-        return;
+        return false;
     }
     auto config = configRes.unwrap();
 
     JsonChecker checker(config);
     auto root = checker.root("[index/config.json]").obj();
 
+    struct Job {
+        std::string modID;
+        ghc::filesystem::path rootDir;
+        ghc::filesystem::path dir;
+        bool isLatest;
+        IndexItemHandle item;
+    };
+    std::vector<Job> jobs;
     for (auto& [modID, entry] : root.has("entries").items()) {
         auto versions = entry.obj().has("versions");
         for (auto& version : entry.obj().has("versions").iterate()) {
-            s_jsonCheckerShouldCheckUnknownKeys =
-                version.get<std::string>() == (versions.iterate().end() - 1)->get<std::string>();
-
             auto rootDir = entriesRoot / modID;
-            auto dir = rootDir / version.get<std::string>();
+            jobs.push_back(Job {
+                .modID = modID,
+                .rootDir = rootDir,
+                .dir = rootDir / version.get<std::string>(),
+                .isLatest = version.get<std::string>() == (versions.iterate().end() - 1)->get<std::string>(),
+            });
+        }
+    }
 
-            auto addRes = IndexItem::Impl::create(rootDir, dir);
-            if (!addRes) {
-                // log::warn("Unable to add index item from {}: {}", dir, addRes.unwrapErr());
-                continue;
-            }
-            auto add = addRes.unwrap();
-            auto metadata = add->getMetadata();
+    // every item only reads its own files, so they can all be read at once
+    ThreadPool::get()->parallelFor(jobs.size(), [&](size_t i) {
+        auto& job = jobs[i];
+        s_jsonCheckerShouldCheckUnknownKeys = job.isLatest;
+        auto addRes = IndexItem::Impl::create(job.rootDir, job.dir);
+        s_jsonCheckerShouldCheckUnknownKeys = true;
+        if (!addRes) {
+            // log::warn("Unable to add index item from {}: {}", job.dir, addRes.unwrapErr());
+            return;
+        }
+        job.item = addRes.unwrap();
+    });
 
-            lock.lock();
-            m_items[modID].insert({metadata.getVersion(),
-                add
-            });
-            lock.unlock();
+    std::unordered_map<std::string, ItemVersions> items;
+    for (auto& job : jobs) {
+        if (job.item) {
+            auto version = job.item->getMetadata().getVersion();
+            items[job.modID].insert({ version, std::move(job.item) });
         }
     }
 
+    std::scoped_lock lock(m_itemsMutex);
+    m_items = std::move(items);
+    return true;
+}
+
+void Index::Impl::updateFromLocalTree() {
+    log::debug("Updating local index cache");
+    log::pushNest();
+    std::unique_lock<std::mutex> lock(m_itemsMutex);
+
+    // the index update events all go in the background lane so they arrive 
+    // in the order they were posted
+    Loader::get()->queueInMainThread([](){
+        IndexUpdateEvent(UpdateProgress(100, "Updating local cache")).post();
+    }, Loader::TaskPriority::Background);
+    // delete old items
+    m_items.clear();
+    lock.unlock();
+
+    // the snapshot is compiled from the local tree once per index revision, 
+    // and removed whenever the tree is updated
+    auto revision = file::readString(dirs::getIndexDir() / ".checksum").unwrapOr("");
+    if (!this->loadSnapshot(revision)) {
+        if (!this->loadLocalTree()) {
+            log::popNest();
+            return;
+        }
+        this->saveSnapshot(revision);
+    }
+
     // mark source as finished
     m_isUpToDate = true;
     
     Loader::get()->queueInMainThread([](){
         IndexUpdateEvent(UpdateFinished()).post();
-    });
+    }, Loader::TaskPriority::Background);
 
     log::debug("Done");
     log::popNest();
@@ -567,7 +852,7 @@ std::vector<IndexItemHandle> Index::getItemsByDeveloper(
     std::vector<IndexItemHandle> res;
     for (auto& items : map::values(m_impl->m_items)) {
         for (auto& item : items) {
-            if (ranges::contains(item.second->getMetadata().getDevelopers(), name)) {
+            if (ranges::contains(item.second->m_impl->m_developers, name)) {
                 res.push_back(item.second);
             }
         }
@@ -599,8 +884,9 @@ IndexItemHandle Index::getMajorItem(
     std::string const& id
 ) const {
     std::scoped_lock lock(m_impl->m_itemsMutex);
-    if (m_impl->m_items.count(id)) {
-        return m_impl->m_items.at(id).rbegin()->second;
+    auto it = m_impl->m_items.find(id);
+    if (it != m_impl->m_items.end() && !it->second.empty()) {
+        return it->second.rbegin()->second;
     }
     return nullptr;
 }
@@ -609,19 +895,18 @@ IndexItemHandle Index::getItem(
     std::string const& id,
     std::optional<VersionInfo> version
 ) const {
-    std::unique_lock<std::mutex> lock(m_impl->m_itemsMutex);
-    if (m_impl->m_items.count(id)) {
-        auto versions = m_impl->m_items.at(id);
-        if (version) {
-            for (auto& [_, item] : ranges::reverse(m_impl->m_items.at(id))) {
-                if (version.value() == item->getMetadata().getVersion()) {
-                    return item;
-                }
-            }
+    std::scoped_lock lock(m_impl->m_itemsMutex);
+    auto it = m_impl->m_items.find(id);
+    if (it == m_impl->m_items.end() || it->second.empty()) {
+        return nullptr;
+    }
+    if (version) {
+        auto item = it->second.find(version.value());
+        if (item != it->second.end()) {
+            return item->second;
         }
     }
-    lock.unlock();
-    return this->getMajorItem(id);
+    return it->second.rbegin()->second;
 }
 
 IndexItemHandle Index::getItem(
@@ -631,8 +916,8 @@ IndexItemHandle Index::getItem(
     std::scoped_lock lock(m_impl->m_itemsMutex);
     if (m_impl->m_items.count(id)) {
         // prefer most major version
-        for (auto& [_, item] : ranges::reverse(m_impl->m_items.at(id))) {
-            if (version.compare(item->getMetadata().getVersion())) {
+        for (auto& [itemVersion, item] : ranges::reverse(m_impl->m_items.at(id))) {
+            if (version.compare(itemVersion)) {
                 return item;
             }
         }
@@ -761,6 +1046,18 @@ Result<IndexInstallList> Index::getInstallList(IndexItemHandle item) const {
     return Ok(list);
 }
 
+namespace {
+    // hash of a download built from the chunks it receives. a request that 
+    // joined one already in progress doesn't see it from the start, in which 
+    // case the file has to be hashed once it's done instead
+    struct DownloadHash {
+        IncrementalHash hash;
+        size_t nextOffset = 0;
+        // whether every chunk from the start of the file was seen
+        bool complete = false;
+    };
+}
+
 void Index::Impl::installNext(size_t index, IndexInstallList const& list) {
     auto postError = [this, list](std::string const& error) {
         m_runningInstallations.erase(list.target);
@@ -813,37 +1110,77 @@ void Index::Impl::installNext(size_t index, IndexInstallList const& list) {
 
     auto item = list.list.at(index);
     auto tempFile = dirs::getTempDir() / (item->getMetadata().getID() + ".index");
+    // kept if the download fails, so retrying continues where it left off. 
+    // named after the expected package so a different version is never 
+    // resumed from the old one's partial file
+    auto partFile = dirs::getTempDir() / fmt::format(
+        "{}-{}.index.part", item->getMetadata().getID(), item->getPackageHash()
+    );
+    // partial files of other versions of the mod can't be resumed anymore
+    {
+        auto prefix = item->getMetadata().getID() + "-";
+        std::string_view suffix = ".index.part";
+        std::error_code ec;
+        for (auto& entry : ghc::filesystem::directory_iterator(dirs::getTempDir(), ec)) {
+            auto name = entry.path().filename().string();
+            if (
+                entry.path() == partFile ||
+                !name.starts_with(prefix) || !name.ends_with(suffix) ||
+                // hashes have no dashes, so this isn't another mod whose ID 
+                // starts with this one's
+                name.find('-', prefix.size()) != std::string::npos
+            ) {
+                continue;
+            }
+            ghc::filesystem::remove(entry.path(), ec);
+        }
+    }
+    // the file is hashed as it's downloaded instead of being read back
+    auto hash = std::make_shared<DownloadHash>();
     log::debug("Installing {}", item->getMetadata().getID());
     m_runningInstallations[list.target] = web::AsyncWebRequest()
         .join("install_item_" + item->getMetadata().getID())
+        .received([hash](uint8_t const* data, size_t size, size_t offset) {
+            if (offset == 0) {
+                hash->hash.reset();
+                hash->nextOffset = 0;
+                hash->complete = true;
+            }
+            if (offset != hash->nextOffset) {
+                hash->complete = false;
+            }
+            if (hash->complete) {
+                hash->hash.add(data, size);
+            }
+            hash->nextOffset = offset + size;
+        })
         .fetch(item->getDownloadURL())
-        .into(tempFile)
+        .resumeInto(partFile)
         .then([=, this](auto) {
-            // Check for 404
-            auto notFound = utils::file::readString(tempFile);
-            if (notFound && notFound.unwrap() == "Not Found") {
+            // if another install of the same item was already downloading it, 
+            // its callbacks ran first and may have moved the file already
+            auto downloaded = ghc::filesystem::exists(partFile) ? partFile : tempFile;
+            auto downloadHash = hash->complete ? hash->hash.getHash() : calculateHash(downloaded);
+            if (downloadHash != item->getPackageHash()) {
+                // don't resume from a broken file next time
+                std::error_code ec;
+                ghc::filesystem::remove(downloaded, ec);
                 return postError(fmt::format(
-                    "Binary file download for {} returned \"404 Not found\". "
-                    "Report this to the Geode development team.",
+                    "Checksum mismatch with {}! (Downloaded file did not match what "
+                    "was expected. Try again, and if the download fails another time, "
+                    "report this to the Geode development team.)",
                     item->getMetadata().getID()
                 ));
             }
 
-            // Verify checksum
-            ModInstallEvent(
-                list.target->getMetadata().getID(),
-                UpdateProgress(
-                    scaledProgress(100),
-                    fmt::format("Verifying {}", item->getMetadata().getID())
-                )
-            ).post();
-
-            if (::calculateHash(tempFile) != item->getPackageHash()) {
+            std::error_code ec;
+            if (downloaded == partFile) {
+                ghc::filesystem::rename(partFile, tempFile, ec);
+            }
+            if (ec) {
                 return postError(fmt::format(
-                    "Checksum mismatch with {}! (Downloaded file did not match what "
-                    "was expected. Try again, and if the download fails another time, "
-                    "report this to the Geode development team.)",
-                    item->getMetadata().getID()
+                    "Unable to move downloaded file for {}: {}",
+                    item->getMetadata().getID(), ec.message()
                 ));
             }
 
@@ -854,7 +1191,14 @@ void Index::Impl::installNext(size_t index, IndexInstallList const& list) {
             // Install next item in queue
             this->installNext(index + 1, list);
         })
-        .expect([postError, list, item](std::string const& err) {
+        .expect([postError, list, item](std::string const& err, int code) {
+            if (code == 404) {
+                return postError(fmt::format(
+                    "Binary file download for {} returned \"404 Not found\". "
+                    "Report this to the Geode development team.",
+                    item->getMetadata().getID()
+                ));
+            }
             postError(fmt::format(
                 "Unable to download {}: {}",
                 item->getMetadata().getID(), err
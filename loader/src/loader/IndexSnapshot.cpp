@@ -0,0 +1,350 @@
+#include "IndexSnapshot.hpp"
+#include "MappedFile.hpp"
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace geode::prelude;
+
+static constexpr char MAGIC[4] = { 'G', 'I', 'D', 'X' };
+static constexpr uint16_t VERSION = 3;
+
+namespace {
+    struct Str {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t reserved;
+        Str revision;
+        uint32_t modCount;
+        uint32_t itemCount;
+        uint32_t tagCount;
+        uint32_t developerCount;
+        uint32_t listSize;
+        uint32_t stringsSize;
+    };
+
+    struct ModRecord {
+        Str id;
+        uint32_t firstItem;
+        uint32_t itemCount;
+    };
+
+    struct ItemRecord {
+        Str version;
+        Str name;
+        Str description;
+        Str directory;
+        Str modJson;
+        Str downloadURL;
+        Str packageHash;
+        Str details;
+        uint32_t platforms;
+        uint32_t featured;
+        uint32_t firstTag;
+        uint32_t tagCount;
+        uint32_t firstDeveloper;
+        uint32_t developerCount;
+    };
+
+    // every section is a multiple of 4 bytes, so the records can be read
+    // in place from the mapped file
+    static_assert(sizeof(Header) % 4 == 0 && sizeof(ModRecord) % 4 == 0 && sizeof(ItemRecord) % 4 == 0);
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<ItemRecord>);
+
+    class StringTable {
+        std::string m_data;
+        std::unordered_map<std::string, Str> m_added;
+
+    public:
+        Str add(std::string const& str) {
+            auto it = m_added.find(str);
+            if (it != m_added.end()) {
+                return it->second;
+            }
+            auto res = Str { static_cast<uint32_t>(m_data.size()), static_cast<uint32_t>(str.size()) };
+            m_data += str;
+            m_added.insert({ str, res });
+            return res;
+        }
+
+        std::string const& data() const {
+            return m_data;
+        }
+    };
+}
+
+template <class T>
+static void writeRecords(std::string& out, std::vector<T> const& records) {
+    out.append(reinterpret_cast<char const*>(records.data()), records.size() * sizeof(T));
+}
+
+// Builder
+
+void IndexSnapshot::Builder::addMod(std::string id) {
+    m_mods.push_back({ std::move(id), {} });
+}
+
+void IndexSnapshot::Builder::addItem(
+    std::string version, std::string name, std::string description,
+    std::string directory, std::string modJson,
+    std::string downloadURL, std::string packageHash, std::string details,
+    uint32_t platforms, bool featured,
+    std::vector<std::string> tags, std::vector<std::string> developers
+) {
+    m_mods.back().second.push_back(ItemData {
+        .version = std::move(version),
+        .name = std::move(name),
+        .description = std::move(description),
+        .directory = std::move(directory),
+        .modJson = std::move(modJson),
+        .downloadURL = std::move(downloadURL),
+        .packageHash = std::move(packageHash),
+        .details = std::move(details),
+        .platforms = platforms,
+        .featured = featured,
+        .tags = std::move(tags),
+        .developers = std::move(developers),
+    });
+}
+
+std::string IndexSnapshot::Builder::build(std::string_view revision) const {
+    StringTable strings;
+    std::vector<ModRecord> mods;
+    std::vector<ItemRecord> items;
+    std::vector<Str> tags;
+    std::vector<Str> developers;
+    std::unordered_map<std::string, uint32_t> tagIndices;
+    std::unordered_map<std::string, uint32_t> developerIndices;
+    std::vector<uint32_t> lists;
+
+    auto addToList = [&](std::vector<std::string> const& values, std::vector<Str>& table, auto& indices) {
+        for (auto& value : values) {
+            auto it = indices.find(value);
+            if (it == indices.end()) {
+                it = indices.insert({ value, static_cast<uint32_t>(table.size()) }).first;
+                table.push_back(strings.add(value));
+            }
+            lists.push_back(it->second);
+        }
+    };
+
+    for (auto& [id, versions] : m_mods) {
+        mods.push_back(ModRecord {
+            .id = strings.add(id),
+            .firstItem = static_cast<uint32_t>(items.size()),
+            .itemCount = static_cast<uint32_t>(versions.size()),
+        });
+        for (auto& data : versions) {
+            ItemRecord item {
+                .version = strings.add(data.version),
+                .name = strings.add(data.name),
+                .description = strings.add(data.description),
+                .directory = strings.add(data.directory),
+                .modJson = strings.add(data.modJson),
+                .downloadURL = strings.add(data.downloadURL),
+                .packageHash = strings.add(data.packageHash),
+                .details = strings.add(data.details),
+                .platforms = data.platforms,
+                .featured = data.featured,
+            };
+            item.firstTag = static_cast<uint32_t>(lists.size());
+            item.tagCount = static_cast<uint32_t>(data.tags.size());
+            addToList(data.tags, tags, tagIndices);
+            item.firstDeveloper = static_cast<uint32_t>(lists.size());
+            item.developerCount = static_cast<uint32_t>(data.developers.size());
+            addToList(data.developers, developers, developerIndices);
+            items.push_back(item);
+        }
+    }
+
+    Header header {
+        .magic = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] },
+        .version = VERSION,
+        .reserved = 0,
+        .revision = strings.add(std::string(revision)),
+        .modCount = static_cast<uint32_t>(mods.size()),
+        .itemCount = static_cast<uint32_t>(items.size()),
+        .tagCount = static_cast<uint32_t>(tags.size()),
+        .developerCount = static_cast<uint32_t>(developers.size()),
+        .listSize = static_cast<uint32_t>(lists.size()),
+        .stringsSize = static_cast<uint32_t>(strings.data().size()),
+    };
+
+    std::string out;
+    out.append(reinterpret_cast<char const*>(&header), sizeof(header));
+    writeRecords(out, mods);
+    writeRecords(out, items);
+    writeRecords(out, tags);
+    writeRecords(out, developers);
+    writeRecords(out, lists);
+    out += strings.data();
+    return out;
+}
+
+// IndexSnapshot
+
+IndexSnapshot::IndexSnapshot() = default;
+IndexSnapshot::~IndexSnapshot() = default;
+
+Result<std::shared_ptr<IndexSnapshot>> IndexSnapshot::open(ghc::filesystem::path const& path) {
+    auto snapshot = std::shared_ptr<IndexSnapshot>(new IndexSnapshot());
+    GEODE_UNWRAP_INTO(snapshot->m_file, MappedFile::open(path));
+    GEODE_UNWRAP(snapshot->init());
+    return Ok(snapshot);
+}
+
+Result<> IndexSnapshot::init() {
+    auto data = m_file->data();
+    auto size = m_file->size();
+
+    if (size < sizeof(Header)) {
+        return Err("Snapshot is truncated");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return Err("Not an index snapshot");
+    }
+    if (header.version != VERSION) {
+        return Err("Unsupported snapshot version {}", header.version);
+    }
+
+    // 64-bit math so huge counts in a corrupted header can't overflow
+    uint64_t expected = sizeof(Header) +
+        uint64_t(header.modCount) * sizeof(ModRecord) +
+        uint64_t(header.itemCount) * sizeof(ItemRecord) +
+        uint64_t(header.tagCount) * sizeof(Str) +
+        uint64_t(header.developerCount) * sizeof(Str) +
+        uint64_t(header.listSize) * sizeof(uint32_t) +
+        header.stringsSize;
+    if (expected != size) {
+        return Err("Snapshot has the wrong size");
+    }
+
+    auto pos = data + sizeof(Header);
+    auto mods = reinterpret_cast<ModRecord const*>(pos);
+    pos += header.modCount * sizeof(ModRecord);
+    auto items = reinterpret_cast<ItemRecord const*>(pos);
+    pos += header.itemCount * sizeof(ItemRecord);
+    auto tags = reinterpret_cast<Str const*>(pos);
+    pos += header.tagCount * sizeof(Str);
+    auto developers = reinterpret_cast<Str const*>(pos);
+    pos += header.developerCount * sizeof(Str);
+    auto lists = reinterpret_cast<uint32_t const*>(pos);
+    pos += header.listSize * sizeof(uint32_t);
+    m_strings = std::string_view(reinterpret_cast<char const*>(pos), header.stringsSize);
+
+    // check every reference once here so reading items doesn't have to
+    auto validStr = [&](Str const& str) {
+        return uint64_t(str.offset) + str.size <= header.stringsSize;
+    };
+    auto validList = [&](uint32_t first, uint32_t count, uint32_t tableSize) {
+        if (uint64_t(first) + count > header.listSize) {
+            return false;
+        }
+        for (uint32_t i = first; i < first + count; i++) {
+            if (lists[i] >= tableSize) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!validStr(header.revision)) {
+        return Err("Snapshot is corrupted");
+    }
+    for (uint32_t i = 0; i < header.modCount; i++) {
+        auto& mod = mods[i];
+        if (!validStr(mod.id) || uint64_t(mod.firstItem) + mod.itemCount > header.itemCount) {
+            return Err("Snapshot is corrupted");
+        }
+    }
+    for (uint32_t i = 0; i < header.itemCount; i++) {
+        auto& item = items[i];
+        if (
+            !validStr(item.version) || !validStr(item.name) || !validStr(item.description) ||
+            !validStr(item.directory) || !validStr(item.modJson) ||
+            !validStr(item.downloadURL) || !validStr(item.packageHash) || !validStr(item.details) ||
+            !validList(item.firstTag, item.tagCount, header.tagCount) ||
+            !validList(item.firstDeveloper, item.developerCount, header.developerCount)
+        ) {
+            return Err("Snapshot is corrupted");
+        }
+    }
+    for (uint32_t i = 0; i < header.tagCount; i++) {
+        if (!validStr(tags[i])) {
+            return Err("Snapshot is corrupted");
+        }
+    }
+    for (uint32_t i = 0; i < header.developerCount; i++) {
+        if (!validStr(developers[i])) {
+            return Err("Snapshot is corrupted");
+        }
+    }
+
+    m_revision = m_strings.substr(header.revision.offset, header.revision.size);
+    m_modCount = header.modCount;
+    m_itemCount = header.itemCount;
+    m_mods = mods;
+    m_items = items;
+    m_tags = tags;
+    m_developers = developers;
+    m_lists = lists;
+    m_listSize = header.listSize;
+    return Ok();
+}
+
+std::string_view IndexSnapshot::getRevision() const {
+    return m_revision;
+}
+
+size_t IndexSnapshot::getModCount() const {
+    return m_modCount;
+}
+
+size_t IndexSnapshot::getItemCount() const {
+    return m_itemCount;
+}
+
+IndexSnapshot::Mod IndexSnapshot::getMod(size_t index) const {
+    auto& mod = static_cast<ModRecord const*>(m_mods)[index];
+    return Mod {
+        .id = m_strings.substr(mod.id.offset, mod.id.size),
+        .firstItem = mod.firstItem,
+        .itemCount = mod.itemCount,
+    };
+}
+
+IndexSnapshot::Item IndexSnapshot::getItem(size_t index) const {
+    auto& item = static_cast<ItemRecord const*>(m_items)[index];
+    auto str = [&](Str const& str) {
+        return m_strings.substr(str.offset, str.size);
+    };
+    auto list = [&](uint32_t first, uint32_t count, void const* table) {
+        std::vector<std::string_view> res;
+        res.reserve(count);
+        for (uint32_t i = first; i < first + count; i++) {
+            res.push_back(str(static_cast<Str const*>(table)[m_lists[i]]));
+        }
+        return res;
+    };
+    return Item {
+        .version = str(item.version),
+        .name = str(item.name),
+        .description = str(item.description),
+        .directory = str(item.directory),
+        .modJson = str(item.modJson),
+        .downloadURL = str(item.downloadURL),
+        .packageHash = str(item.packageHash),
+        .details = str(item.details),
+        .platforms = item.platforms,
+        .featured = item.featured != 0,
+        .tags = list(item.firstTag, item.tagCount, m_tags),
+        .developers = list(item.firstDeveloper, item.developerCount, m_developers),
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <Geode/utils/Result.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class MappedFile;
+
+namespace geode {
+    /**
+     * The parts of the index needed to list its items, compiled into a single
+     * file once per index revision so it doesn't have to be read from
+     * thousands of small files on every launch. The file is mapped into
+     * memory and read in place.
+     *
+     * File: header, mod records, item records, tag table, developer table,
+     *       lists, string table
+     * Header: char[4] magic, u16 version, u16 reserved, str revision,
+     *         u32 mod count, u32 item count, u32 tag count,
+     *         u32 developer count, u32 list size, u32 string table size
+     * Mod: str id, u32 first item, u32 item count
+     * Item: str version, str name, str description, str directory, 
+     *       str mod.json, str download url, str package hash, str details,
+     *       u32 platforms, u32 featured, u32 first tag, u32 tag count,
+     *       u32 first developer, u32 developer count
+     * Tags and developers are strs. An item's tags and developers are runs
+     * of indices into those tables stored in the lists. A str is a u32
+     * offset into the string table followed by a u32 length. Each mod's items
+     * are consecutive and sorted by version. All integers are little-endian
+     */
+    class IndexSnapshot final {
+    public:
+        struct Mod {
+            std::string_view id;
+            size_t firstItem;
+            size_t itemCount;
+        };
+
+        struct Item {
+            std::string_view version;
+            std::string_view name;
+            std::string_view description;
+            // name of the item's directory in the mod's directory
+            std::string_view directory;
+            std::string_view modJson;
+            std::string_view downloadURL;
+            std::string_view packageHash;
+            // contents of about.md, which search needs for every item
+            std::string_view details;
+            // bit n is set for PlatformID n, the highest one for unknown platforms
+            uint32_t platforms;
+            bool featured;
+            std::vector<std::string_view> tags;
+            std::vector<std::string_view> developers;
+        };
+
+        /**
+         * Collects items and serializes them into a snapshot
+         */
+        class Builder final {
+        private:
+            struct ItemData {
+                std::string version;
+                std::string name;
+                std::string description;
+                std::string directory;
+                std::string modJson;
+                std::string downloadURL;
+                std::string packageHash;
+                std::string details;
+                uint32_t platforms;
+                bool featured;
+                std::vector<std::string> tags;
+                std::vector<std::string> developers;
+            };
+            std::vector<std::pair<std::string, std::vector<ItemData>>> m_mods;
+
+        public:
+            /**
+             * Start adding the items of a new mod. Items have to be added in
+             * version order
+             */
+            void addMod(std::string id);
+            void addItem(
+                std::string version, std::string name, std::string description,
+                std::string directory, std::string modJson,
+                std::string downloadURL, std::string packageHash, std::string details,
+                uint32_t platforms, bool featured,
+                std::vector<std::string> tags, std::vector<std::string> developers
+            );
+            std::string build(std::string_view revision) const;
+        };
+
+    private:
+        std::unique_ptr<MappedFile> m_file;
+        std::string_view m_revision;
+        size_t m_modCount = 0;
+        size_t m_itemCount = 0;
+        void const* m_mods = nullptr;
+        void const* m_items = nullptr;
+        void const* m_tags = nullptr;
+        void const* m_developers = nullptr;
+        uint32_t const* m_lists = nullptr;
+        size_t m_listSize = 0;
+        std::string_view m_strings;
+
+        IndexSnapshot();
+
+        Result<> init();
+
+    public:
+        static constexpr char const* FILE_NAME = "index-snapshot.bin";
+
+        IndexSnapshot(IndexSnapshot const&) = delete;
+        IndexSnapshot& operator=(IndexSnapshot const&) = delete;
+        ~IndexSnapshot();
+
+        /**
+         * Map a snapshot and check that it's intact
+         */
+        static Result<std::shared_ptr<IndexSnapshot>> open(ghc::filesystem::path const& path);
+
+        std::string_view getRevision() const;
+        size_t getModCount() const;
+        size_t getItemCount() const;
+        Mod getMod(size_t index) const;
+        Item getItem(size_t index) const;
+    };
+}
@@ -73,6 +73,14 @@ void Loader::queueInMainThread(ScheduledFunction func) {
     return m_impl->queueInMainThread(std::move(func));
 }
 
+void Loader::queueInMainThread(ScheduledFunction func, TaskPriority priority) {
+    return m_impl->queueInMainThread(std::move(func), priority);
+}
+
+Loader::MainThreadQueueStats Loader::getMainThreadQueueStats() const {
+    return m_impl->getMainThreadQueueStats();
+}
+
 Mod* Loader::takeNextMod() {
     return m_impl->takeNextMod();
 }
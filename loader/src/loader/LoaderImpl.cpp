@@ -5,6 +5,7 @@
 #include "ModMetadataImpl.hpp"
 #include "LogImpl.hpp"
 #include "console.hpp"
+#include "ThreadPool.hpp"
 
 #include <Geode/loader/Dirs.hpp>
 #include <Geode/loader/IPC.hpp>
@@ -153,7 +154,24 @@ VersionInfo Loader::Impl::maxModVersion() {
     };
 }
 
+// oldest version mods can target. betas normally load mods built for 
+// earlier betas, but these broke the ABI:
+//  - beta.27: MiniFunction stores small callables inline, so it's no longer 
+//    the size of a pointer
+//  - beta.27: EventListenerProtocol got new virtuals and 
+//    DefaultEventListenerPool groups its listeners by event class
+//  - beta.27: fields are stored in per-class blocks instead of a vector of 
+//    pointers that mods allocated themselves
+//  - beta.27: AsyncWebRequest::setThen callbacks take the response data 
+//    by rvalue reference
+static constexpr VersionInfo MIN_MOD_ABI_VERSION {
+    2, 0, 0, VersionTag(VersionTag::Beta, 27)
+};
+
 bool Loader::Impl::isModVersionSupported(VersionInfo const& target) {
+    if (target < MIN_MOD_ABI_VERSION) {
+        return false;
+    }
     return semverCompare(this->getVersion(), target);
 }
 
@@ -161,13 +179,10 @@ bool Loader::Impl::isModVersionSupported(VersionInfo const& target) {
 
 void Loader::Impl::saveData() {
     for (auto& [id, mod] : m_mods) {
-        log::debug("{}", mod->getID());
-        log::pushNest();
-        auto r = mod->saveData();
+        auto r = ModImpl::getImpl(mod)->saveChangedData();
         if (!r) {
             log::warn("Unable to save data for mod \"{}\": {}", mod->getID(), r.unwrapErr());
         }
-        log::popNest();
     }
 }
 
@@ -254,55 +269,213 @@ void Loader::Impl::addProblem(LoadProblem const& problem) {
     m_problems.push_back(problem);
 }
 
+// Mod metadata cache
+
+// Bump whenever the layout of the cache file changes
+static constexpr int MOD_METADATA_CACHE_VERSION = 1;
+
+static ghc::filesystem::path getModMetadataCachePath() {
+    return dirs::getModRuntimeDir() / "metadata-cache.json";
+}
+
+static std::string getModFileStamp(ghc::filesystem::path const& path) {
+    std::error_code ec;
+    auto size = ghc::filesystem::file_size(path, ec);
+    if (ec) return "";
+    auto modified = ghc::filesystem::last_write_time(path, ec);
+    if (ec) return "";
+    auto modifiedCount = std::chrono::duration_cast<std::chrono::milliseconds>(modified.time_since_epoch());
+    return fmt::format("{}:{}", size, modifiedCount.count());
+}
+
+void Loader::Impl::loadModMetadataCache() {
+    m_modMetadataCache = matjson::Object();
+    auto path = getModMetadataCachePath();
+    if (!ghc::filesystem::exists(path)) {
+        return;
+    }
+    auto data = file::readString(path);
+    if (!data) {
+        log::warn("Unable to read mod metadata cache: {}", data.unwrapErr());
+        return;
+    }
+    std::string error;
+    auto res = matjson::parse(data.unwrap(), error);
+    if (error.size() > 0 || !res.value().is_object()) {
+        log::warn("Mod metadata cache is corrupted, ignoring it");
+        return;
+    }
+    auto json = res.value();
+    // mod.json validation depends on the loader version, so a cache written
+    // by another version can't be trusted
+    if (
+        !json.contains("version") || !json["version"].is_number() ||
+        json["version"].as_int() != MOD_METADATA_CACHE_VERSION ||
+        !json.contains("loader") || !json["loader"].is_string() ||
+        json["loader"].as_string() != this->getVersion().toString() ||
+        !json.contains("mods") || !json["mods"].is_object()
+    ) {
+        log::debug("Mod metadata cache is outdated, ignoring it");
+        return;
+    }
+    m_modMetadataCache = json["mods"];
+}
+
+void Loader::Impl::saveModMetadataCache() {
+    auto json = matjson::Object();
+    json["version"] = MOD_METADATA_CACHE_VERSION;
+    json["loader"] = this->getVersion().toString();
+    json["mods"] = m_modMetadataCache;
+    auto res = file::writeString(getModMetadataCachePath(), matjson::Value(json).dump(matjson::NO_INDENTATION));
+    if (!res) {
+        log::warn("Unable to save mod metadata cache: {}", res.unwrapErr());
+    }
+}
+
 // Dependencies and refreshing
 
 void Loader::Impl::queueMods(std::vector<ModMetadata>& modQueue) {
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    std::vector<ghc::filesystem::path> paths;
     for (auto const& dir : m_modSearchDirectories) {
         log::debug("Searching {}", dir);
-        log::pushNest();
         for (auto const& entry : ghc::filesystem::directory_iterator(dir)) {
             if (!ghc::filesystem::is_regular_file(entry) ||
                 entry.path().extension() != GEODE_MOD_EXTENSION)
                 continue;
+            paths.push_back(entry.path());
+        }
+    }
 
-            log::debug("Found {}", entry.path().filename());
-            log::pushNest();
+    this->loadModMetadataCache();
 
-            auto res = ModMetadata::createFromGeodeFile(entry.path());
-            if (!res) {
-                this->addProblem({
-                    LoadProblem::Type::InvalidFile,
-                    entry.path(),
-                    res.unwrapErr()
-                });
-                log::error("Failed to queue: {}", res.unwrapErr());
-                log::popNest();
-                continue;
+    struct Discovered {
+        std::string stamp;
+        std::optional<Result<ModMetadata>> result;
+        // whether the result came from a valid cache entry
+        bool cached = false;
+        // fresh cache entry, only set if the mod had to be read from its zip
+        std::optional<matjson::Value> cacheEntry;
+    };
+    std::vector<Discovered> discovered(paths.size());
+
+    // the cache is only read from here on, so sharing it between the workers is fine
+    auto const& cache = m_modMetadataCache;
+    ThreadPool::get()->parallelFor(paths.size(), [&](size_t i) {
+        auto const& path = paths[i];
+        auto& item = discovered[i];
+        item.stamp = getModFileStamp(path);
+
+        auto key = path.string();
+        if (!item.stamp.empty() && cache.contains(key)) {
+            auto const& entry = cache[key];
+            if (
+                entry.contains("stamp") && entry["stamp"].is_string() &&
+                entry["stamp"].as_string() == item.stamp && entry.contains("mod.json")
+            ) {
+                auto res = ModMetadata::create(entry["mod.json"]);
+                if (res) {
+                    auto& metadata = res.unwrap();
+                    auto impl = metadata.m_impl.get();
+                    impl->m_path = path;
+                    for (auto& [file, target] : impl->getSpecialFiles()) {
+                        if (entry.contains(file) && entry[file].is_string()) {
+                            *target = entry[file].as_string();
+                        }
+                    }
+                    item.result = std::move(res);
+                    item.cached = true;
+                    return;
+                }
+                // fall through and report the error from the actual file
             }
-            auto modMetadata = res.unwrap();
-
-            log::debug("id: {}", modMetadata.getID());
-            log::debug("version: {}", modMetadata.getVersion());
-            log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+        }
 
-            if (std::find_if(modQueue.begin(), modQueue.end(), [&](auto& item) {
-                    return modMetadata.getID() == item.getID();
-                }) != modQueue.end()) {
-                this->addProblem({
-                    LoadProblem::Type::Duplicate,
-                    modMetadata,
-                    "A mod with the same ID is already present."
-                });
-                log::error("Failed to queue: a mod with the same ID is already queued");
-                log::popNest();
-                continue;
+        item.result = ModMetadata::createFromGeodeFile(path);
+        if (*item.result && !item.stamp.empty()) {
+            auto& metadata = item.result->unwrap();
+            auto entry = matjson::Object();
+            entry["stamp"] = item.stamp;
+            entry["mod.json"] = metadata.getRawJSON();
+            for (auto& [file, target] : metadata.m_impl->getSpecialFiles()) {
+                if (*target) {
+                    entry[file] = target->value();
+                }
             }
+            item.cacheEntry = entry;
+        }
+    });
+
+    size_t cacheHits = 0;
+    size_t cacheUpdates = 0;
+    // rebuilt from scratch so removed mods don't linger in the cache
+    auto newCache = matjson::Object();
+    std::unordered_set<std::string> queuedIDs;
+    for (size_t i = 0; i < paths.size(); i++) {
+        auto const& path = paths[i];
+        auto& item = discovered[i];
+
+        log::debug("Found {}", path.filename());
+        log::pushNest();
+
+        auto& res = *item.result;
+        if (!res) {
+            this->addProblem({
+                LoadProblem::Type::InvalidFile,
+                path,
+                res.unwrapErr()
+            });
+            log::error("Failed to queue: {}", res.unwrapErr());
+            log::popNest();
+            continue;
+        }
+        auto& modMetadata = res.unwrap();
+
+        if (item.cacheEntry) {
+            cacheUpdates += 1;
+            newCache[path.string()] = std::move(*item.cacheEntry);
+        }
+        else if (item.cached) {
+            cacheHits += 1;
+            newCache[path.string()] = m_modMetadataCache[path.string()];
+        }
 
-            modQueue.push_back(modMetadata);
+        log::debug("id: {}", modMetadata.getID());
+        log::debug("version: {}", modMetadata.getVersion());
+        log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+
+        if (!queuedIDs.insert(modMetadata.getID()).second) {
+            this->addProblem({
+                LoadProblem::Type::Duplicate,
+                modMetadata,
+                "A mod with the same ID is already present."
+            });
+            log::error("Failed to queue: a mod with the same ID is already queued");
             log::popNest();
+            continue;
         }
+
+        modQueue.push_back(std::move(modMetadata));
         log::popNest();
     }
+
+    // mods that fail to load have no entry either way, so they don't cause 
+    // the cache to be rewritten on every launch. if nothing was added or 
+    // updated, the only possible change is entries having been removed
+    bool cacheChanged = cacheUpdates > 0 ||
+        cacheHits != m_modMetadataCache.as_object().size();
+    m_modMetadataCache = newCache;
+    if (cacheChanged) {
+        this->saveModMetadataCache();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+    log::info(
+        "Queued {} mods in {}s ({} cached, {} read from disk)",
+        modQueue.size(), static_cast<float>(time) / 1000.f, cacheHits, paths.size() - cacheHits
+    );
 }
 
 void Loader::Impl::populateModList(std::vector<ModMetadata>& modQueue) {
@@ -375,138 +548,292 @@ void Loader::Impl::buildModGraph() {
     }
 }
 
-void Loader::Impl::loadModGraph(Mod* node, bool early) {
-    if (early && !node->needsEarlyLoad()) {
-        m_modsToLoad.push_back(node);
-        return;
+void Loader::Impl::buildLoadLevels() {
+    m_loadLevels.clear();
+    m_currentLoadLevel = 0;
+    m_earlyLoadAttempted.clear();
+
+    // Kahn's algorithm over required dependencies; every mod ends up one 
+    // level after the last of its dependencies, so all mods within a level 
+    // can be unzipped at the same time
+    std::unordered_map<Mod*, size_t> pendingDeps;
+    std::vector<Mod*> level;
+    for (auto const& [id, mod] : m_mods) {
+        if (mod->isInternal())
+            continue;
+        size_t count = 0;
+        for (auto const& dep : mod->m_impl->m_metadata.m_impl->m_dependencies) {
+            if (
+                dep.importance == ModMetadata::Dependency::Importance::Required &&
+                dep.mod && !dep.mod->isInternal()
+            ) {
+                count += 1;
+            }
+        }
+        pendingDeps.insert({ mod, count });
+        if (count == 0) {
+            level.push_back(mod);
+        }
     }
 
+    auto byID = [](Mod* a, Mod* b) {
+        return a->getID() < b->getID();
+    };
+
+    size_t levelledCount = 0;
+    while (!level.empty()) {
+        std::sort(level.begin(), level.end(), byID);
+        std::vector<Mod*> next;
+        for (auto mod : level) {
+            for (auto dependant : mod->m_impl->m_dependants) {
+                if (--pendingDeps[dependant] == 0) {
+                    next.push_back(dependant);
+                }
+            }
+        }
+        levelledCount += level.size();
+        m_loadLevels.push_back(std::move(level));
+        level = std::move(next);
+    }
+
+    // mods in a dependency cycle never become ready, but they still get a 
+    // level so their problems are reported the same way as everyone else's
+    if (levelledCount != pendingDeps.size()) {
+        std::vector<Mod*> cyclic;
+        for (auto const& [mod, pending] : pendingDeps) {
+            if (pending != 0) {
+                cyclic.push_back(mod);
+            }
+        }
+        std::sort(cyclic.begin(), cyclic.end(), byID);
+        log::warn("{} mods have circular dependencies", cyclic.size());
+        m_loadLevels.push_back(std::move(cyclic));
+    }
+
+    log::debug("{} mods in {} levels", pendingDeps.size(), m_loadLevels.size());
+}
+
+bool Loader::Impl::canLoadMod(Mod* node) {
     if (node->hasUnresolvedDependencies()) {
         log::debug("{} {} has unresolved dependencies", node->getID(), node->getVersion());
-        return;
+        return false;
     }
     if (node->hasUnresolvedIncompatibilities()) {
         log::debug("{} {} has unresolved incompatibilities", node->getID(), node->getVersion());
-        return;
+        return false;
     }
 
-    log::debug("{} {}", node->getID(), node->getVersion());
-    log::pushNest();
+    auto res = node->getMetadata().checkGameVersion();
+    if (!res) {
+        this->addProblem({
+            LoadProblem::Type::UnsupportedVersion,
+            node,
+            res.unwrapErr()
+        });
+        log::error("Geometry Dash version {} is required to run this mod", res.unwrapErr());
+        return false;
+    }
 
-    if (node->isEnabled()) {
-        for (auto const& dep : node->m_impl->m_dependants) {
-            m_modsToLoad.push_front(dep);
-        }
-        log::popNest();
-        return;
+    if (!this->isModVersionSupported(node->getMetadata().getGeodeVersion())) {
+        this->addProblem({
+            node->getMetadata().getGeodeVersion() > this->getVersion() ? LoadProblem::Type::NeedsNewerGeodeVersion : LoadProblem::Type::UnsupportedGeodeVersion,
+            node,
+            fmt::format(
+                "Geode version {}\nis required to run this mod\n(installed: {})",
+                node->getMetadata().getGeodeVersion().toString(),
+                this->getVersion().toString()
+            )
+        });
+        log::error("Unsupported Geode version: {}", node->getMetadata().getGeodeVersion());
+        return false;
     }
 
+    return true;
+}
+
+void Loader::Impl::loadModBinary(Mod* node) {
+    auto begin = std::chrono::high_resolution_clock::now();
     m_currentlyLoadingMod = node;
-    m_refreshingModCount += 1;
-    m_refreshedModCount += 1;
-    m_lateRefreshedModCount += early ? 0 : 1;
-
-    auto unzipFunction = [this, node]() {
-        log::debug("Unzip");
-        auto res = node->m_impl->unzipGeodeFile(node->getMetadata());
-        return res;
-    };
 
-    auto loadFunction = [this, node, early]() {
-        if (node->shouldLoad()) {
-            log::debug("Load");
-            auto res = node->m_impl->loadBinary();
+    if (node->shouldLoad()) {
+        log::debug("Load");
+        auto res = node->m_impl->loadBinary();
+        if (!res) {
+            this->addProblem({
+                LoadProblem::Type::LoadFailed,
+                node,
+                res.unwrapErr()
+            });
+            log::error("Failed to load binary: {}", res.unwrapErr());
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_modLoadTimings[node].load = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+}
+
+void Loader::Impl::loadEarlyMods() {
+    for (auto const& level : m_loadLevels) {
+        for (auto node : level) {
+            if (!node->needsEarlyLoad() || node->isEnabled())
+                continue;
+
+            log::debug("{} {}", node->getID(), node->getVersion());
+            log::pushNest();
+
+            if (!this->canLoadMod(node)) {
+                // a mod may depend on mods that aren't loaded early, so it 
+                // gets another chance once they are. anything else that 
+                // stops it from loading has been reported already
+                if (!node->hasUnresolvedDependencies() && !node->hasUnresolvedIncompatibilities()) {
+                    m_earlyLoadAttempted.insert(node);
+                }
+                log::popNest();
+                continue;
+            }
+
+            m_earlyLoadAttempted.insert(node);
+            m_refreshedModCount += 1;
+
+            log::debug("Unzip");
+            auto begin = std::chrono::high_resolution_clock::now();
+            auto res = node->m_impl->unzipGeodeFile(node->getMetadata());
+            auto end = std::chrono::high_resolution_clock::now();
+            m_modLoadTimings[node].unzip = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
             if (!res) {
                 this->addProblem({
-                    LoadProblem::Type::LoadFailed,
+                    LoadProblem::Type::UnzipFailed,
                     node,
                     res.unwrapErr()
                 });
-                log::error("Failed to load binary: {}", res.unwrapErr());
-                m_refreshingModCount -= 1;
-                return;
+                log::error("Failed to unzip: {}", res.unwrapErr());
+                log::popNest();
+                continue;
             }
 
-            for (auto const& dep : node->m_impl->m_dependants) {
-                m_modsToLoad.push_front(dep);
-            }
+            this->loadModBinary(node);
+            log::popNest();
         }
+    }
+}
 
-        m_refreshingModCount -= 1;
-    };
+void Loader::Impl::queueLoadLevel(std::vector<Mod*> const& level) {
+    for (auto node : level) {
+        // mods that failed to load early have already reported why
+        if (node->isEnabled() || m_earlyLoadAttempted.contains(node))
+            continue;
 
-    {   // version checking
-        auto res = node->getMetadata().checkGameVersion();
-        if (!res) {
-            this->addProblem({
-                LoadProblem::Type::UnsupportedVersion,
-                node,
-                res.unwrapErr()
-            });
-            log::error("Geometry Dash version {} is required to run this mod", res.unwrapErr());
-            m_refreshingModCount -= 1;
+        log::debug("{} {}", node->getID(), node->getVersion());
+        log::pushNest();
+
+        if (!this->canLoadMod(node)) {
             log::popNest();
-            return;
+            continue;
         }
 
-        if (!this->isModVersionSupported(node->getMetadata().getGeodeVersion())) {
-            this->addProblem({
-                node->getMetadata().getGeodeVersion() > this->getVersion() ? LoadProblem::Type::NeedsNewerGeodeVersion : LoadProblem::Type::UnsupportedGeodeVersion,
-                node,
-                fmt::format(
-                    "Geode version {}\nis required to run this mod\n(installed: {})",
-                    node->getMetadata().getGeodeVersion().toString(),
-                    this->getVersion().toString()
-                )
+        m_refreshingModCount += 1;
+        m_refreshedModCount += 1;
+        m_lateRefreshedModCount += 1;
+
+        auto nest = log::saveNest();
+        ThreadPool::get()->push([this, node, nest]() {
+            log::loadNest(nest);
+            log::debug("Unzip {}", node->getID());
+            auto begin = std::chrono::high_resolution_clock::now();
+            auto res = node->m_impl->unzipGeodeFile(node->getMetadata());
+            auto end = std::chrono::high_resolution_clock::now();
+
+            std::lock_guard lock(m_unzippedModsMutex);
+            m_unzippedMods.push_back({
+                node, std::move(res), std::chrono::duration_cast<std::chrono::microseconds>(end - begin)
             });
-            log::error("Unsupported Geode version: {}", node->getMetadata().getGeodeVersion());
-            m_refreshingModCount -= 1;
-            log::popNest();
-            return;
+        });
+
+        log::popNest();
+    }
+}
+
+void Loader::Impl::loadUnzippedMods() {
+    {
+        std::lock_guard lock(m_unzippedModsMutex);
+        for (auto& unzipped : m_unzippedMods) {
+            m_modsToLoad.push_back(std::move(unzipped));
         }
+        m_unzippedMods.clear();
     }
 
-    if (early) {
-        auto res = unzipFunction();
-        if (!res) {
+    auto budget = std::chrono::milliseconds(std::max<int64_t>(
+        Mod::get()->getSettingValue<int64_t>("mod-load-frame-budget"), 1
+    ));
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    // always load at least one mod per frame, even if it alone is over budget
+    while (!m_modsToLoad.empty()) {
+        auto unzipped = std::move(m_modsToLoad.front());
+        m_modsToLoad.pop_front();
+        auto node = unzipped.mod;
+
+        log::debug("{} {}", node->getID(), node->getVersion());
+        log::pushNest();
+
+        m_modLoadTimings[node].unzip = unzipped.time;
+        if (!unzipped.result) {
             this->addProblem({
                 LoadProblem::Type::UnzipFailed,
                 node,
-                res.unwrapErr()
+                unzipped.result.unwrapErr()
             });
-            log::error("Failed to unzip: {}", res.unwrapErr());
-            m_refreshingModCount -= 1;
-            log::popNest();
-            return;
+            log::error("Failed to unzip: {}", unzipped.result.unwrapErr());
+        }
+        else {
+            this->loadModBinary(node);
         }
-        loadFunction();
+        m_refreshingModCount -= 1;
+
+        log::popNest();
+
+        if (std::chrono::high_resolution_clock::now() - begin >= budget)
+            break;
     }
-    else {
-        auto nest = log::saveNest();
-        std::thread([=, this]() {
-            thread::setName("Mod Unzip");
-            log::loadNest(nest);
-            auto res = unzipFunction();
-            this->queueInMainThread([=, this]() {
-                auto prevNest = log::saveNest();
-                log::loadNest(nest);
-                if (!res) {
-                    this->addProblem({
-                        LoadProblem::Type::UnzipFailed,
-                        node,
-                        res.unwrapErr()
-                    });
-                    log::error("Failed to unzip: {}", res.unwrapErr());
-                    m_refreshingModCount -= 1;
-                    log::loadNest(prevNest);
-                    return;
-                }
-                loadFunction();
-                log::loadNest(prevNest);
-            });
-        }).detach();
+}
+
+bool Loader::Impl::continueLoadLevels() {
+    this->loadUnzippedMods();
+    // a level can only start once every mod of the previous one is loaded
+    while (m_refreshingModCount == 0) {
+        if (m_currentLoadLevel >= m_loadLevels.size()) {
+            return true;
+        }
+        this->queueLoadLevel(m_loadLevels[m_currentLoadLevel]);
+        m_currentLoadLevel += 1;
+    }
+    return false;
+}
+
+void Loader::Impl::logModLoadTimings() {
+    std::vector<std::pair<Mod*, ModLoadTiming>> timings(m_modLoadTimings.begin(), m_modLoadTimings.end());
+    if (timings.empty())
+        return;
+    std::sort(timings.begin(), timings.end(), [](auto const& a, auto const& b) {
+        return a.second.unzip + a.second.load > b.second.unzip + b.second.load;
+    });
+
+    auto toMs = [](std::chrono::microseconds time) {
+        return static_cast<float>(time.count()) / 1000.f;
+    };
+
+    log::debug("Mod load times");
+    log::pushNest();
+    for (auto const& [mod, timing] : timings) {
+        log::debug("{}: unzip {}ms, load {}ms", mod->getID(), toMs(timing.unzip), toMs(timing.load));
     }
     log::popNest();
+
+    auto const& [slowest, timing] = timings.front();
+    log::info(
+        "Slowest mod to load was {} ({}ms unzipping, {}ms loading)",
+        slowest->getID(), toMs(timing.unzip), toMs(timing.load)
+    );
 }
 
 void Loader::Impl::findProblems() {
@@ -669,12 +996,15 @@ void Loader::Impl::refreshModGraph() {
     this->buildModGraph();
     log::popNest();
 
+    log::debug("Ordering mods by dependencies");
+    log::pushNest();
+    this->buildLoadLevels();
+    log::popNest();
+
     m_loadingState = LoadingState::EarlyMods;
     log::debug("Loading early mods");
     log::pushNest();
-    for (auto const& dep : ModImpl::get()->m_dependants) {
-        this->loadModGraph(dep, true);
-    }
+    this->loadEarlyMods();
     log::popNest();
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -683,10 +1013,8 @@ void Loader::Impl::refreshModGraph() {
 
     log::popNest();
 
-    if (m_modsToLoad.empty())
-        m_loadingState = LoadingState::Problems;
-    else
-        m_loadingState = LoadingState::Mods;
+    m_loadingState = LoadingState::Mods;
+    m_timerBegin = std::chrono::high_resolution_clock::now();
 
     queueInMainThread([&]() {
         this->continueRefreshModGraph();
@@ -694,40 +1022,23 @@ void Loader::Impl::refreshModGraph() {
 }
 
 void Loader::Impl::continueRefreshModGraph() {
-    if (m_refreshingModCount != 0) {
-        queueInMainThread([&]() {
-            this->continueRefreshModGraph();
-        });
-        return;
-    }
-
-    if  (m_lateRefreshedModCount > 0) {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_timerBegin).count();
-        log::info("Took {}s", static_cast<float>(time) / 1000.f);
-    }
-
-    log::info("Continuing mod graph refresh...");
-    log::pushNest();
-
-    m_timerBegin = std::chrono::high_resolution_clock::now();
-
     switch (m_loadingState) {
         case LoadingState::Mods:
-            if (!m_modsToLoad.empty()) {
-                log::debug("Loading mods");
-                log::pushNest();
-                auto mod = m_modsToLoad.front();
-                m_modsToLoad.pop_front();
-                this->loadModGraph(mod, false);
-                log::popNest();
+            if (!this->continueLoadLevels()) {
                 break;
             }
+            if (m_lateRefreshedModCount > 0) {
+                auto end = std::chrono::high_resolution_clock::now();
+                auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_timerBegin).count();
+                log::info("Loaded {} mods in {}s", m_lateRefreshedModCount, static_cast<float>(time) / 1000.f);
+            }
+            this->logModLoadTimings();
             m_loadingState = LoadingState::Problems;
             [[fallthrough]];
         case LoadingState::Problems:
             log::debug("Finding problems");
             log::pushNest();
+            m_timerBegin = std::chrono::high_resolution_clock::now();
             this->findProblems();
             log::popNest();
             m_loadingState = LoadingState::Done;
@@ -749,8 +1060,6 @@ void Loader::Impl::continueRefreshModGraph() {
             this->continueRefreshModGraph();
         });
     }
-
-    log::popNest();
 }
 
 std::vector<LoadProblem> Loader::Impl::getProblems() const {
@@ -789,23 +1098,64 @@ bool Loader::Impl::loadHooks() {
     return !hadErrors;
 }
 
-void Loader::Impl::queueInMainThread(const ScheduledFunction& func) {
-    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-    m_mainThreadQueue.push_back(func);
+void Loader::Impl::queueInMainThread(MainThreadTask func, TaskPriority priority) {
+    m_mainThreadQueueSize.fetch_add(1, std::memory_order_relaxed);
+    m_mainThreadQueues[static_cast<size_t>(priority)].push(std::move(func));
 }
 
 void Loader::Impl::executeMainThreadQueue() {
-    // copy queue to avoid locking mutex if someone is
-    // running addToMainThread inside their function
-    m_mainThreadMutex.lock();
-    auto queue = m_mainThreadQueue;
-    m_mainThreadQueue.clear();
-    m_mainThreadMutex.unlock();
-
-    // call queue
-    for (auto const& func : queue) {
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    // only run what was queued before this frame, so tasks that queue 
+    // themselves again don't keep the frame from ending
+    for (size_t lane = 0; lane < MAIN_THREAD_LANE_COUNT; lane++) {
+        MainThreadTask func;
+        while (m_mainThreadQueues[lane].pop(func)) {
+            m_mainThreadCarryOver[lane].push_back(std::move(func));
+        }
+    }
+
+    size_t count = 0;
+    auto run = [&](std::deque<MainThreadTask>& lane) {
+        auto func = std::move(lane.front());
+        lane.pop_front();
+        m_mainThreadQueueSize.fetch_sub(1, std::memory_order_relaxed);
+        count += 1;
         func();
+    };
+    auto overBudget = [&]() {
+        return std::chrono::high_resolution_clock::now() - begin >= m_mainThreadBudget;
+    };
+
+    // input-critical tasks ignore the budget
+    auto& critical = m_mainThreadCarryOver[static_cast<size_t>(TaskPriority::InputCritical)];
+    while (!critical.empty()) {
+        run(critical);
+    }
+
+    // the rest get at least one task per frame so nothing starves
+    for (auto priority : { TaskPriority::Normal, TaskPriority::Background }) {
+        auto& lane = m_mainThreadCarryOver[static_cast<size_t>(priority)];
+        if (!lane.empty()) {
+            run(lane);
+        }
+        while (!lane.empty() && !overBudget()) {
+            run(lane);
+        }
     }
+
+    m_lastMainThreadDrainTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - begin
+    );
+    m_lastMainThreadDrainCount = count;
+}
+
+Loader::MainThreadQueueStats Loader::Impl::getMainThreadQueueStats() const {
+    return MainThreadQueueStats {
+        .queued = m_mainThreadQueueSize.load(std::memory_order_relaxed),
+        .lastDrainTime = m_lastMainThreadDrainTime,
+        .lastDrainCount = m_lastMainThreadDrainCount,
+    };
 }
 
 void Loader::Impl::provideNextMod(Mod* mod) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "FileWatcher.hpp"
+#include "MPSCQueue.hpp"
 
 #include <matjson.hpp>
 #include <Geode/loader/Dirs.hpp>
@@ -14,6 +15,10 @@
 #include <Geode/utils/MiniFunction.hpp>
 #include "ModImpl.hpp"
 #include <crashlog.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -37,14 +42,45 @@ namespace geode {
         std::vector<ghc::filesystem::path> m_modSearchDirectories;
         std::vector<LoadProblem> m_problems;
         std::unordered_map<std::string, Mod*> m_mods;
-        std::deque<Mod*> m_modsToLoad;
+        struct UnzippedMod {
+            Mod* mod;
+            Result<> result;
+            std::chrono::microseconds time;
+        };
+        struct ModLoadTiming {
+            std::chrono::microseconds unzip {0};
+            std::chrono::microseconds load {0};
+        };
+        // mods grouped so that every mod comes after its required dependencies
+        std::vector<std::vector<Mod*>> m_loadLevels;
+        size_t m_currentLoadLevel = 0;
+        // mods loadEarlyMods already tried to load or reported a problem for
+        std::unordered_set<Mod*> m_earlyLoadAttempted;
+        // filled by the unzip workers, drained on the main thread
+        std::vector<UnzippedMod> m_unzippedMods;
+        std::mutex m_unzippedModsMutex;
+        std::deque<UnzippedMod> m_modsToLoad;
+        std::unordered_map<Mod*, ModLoadTiming> m_modLoadTimings;
+        // parsed mod.json & special files of every .geode file, keyed by
+        // path and invalidated by size / modification time
+        matjson::Value m_modMetadataCache;
         std::vector<ghc::filesystem::path> m_texturePaths;
         bool m_isSetup = false;
 
         LoadingState m_loadingState = LoadingState::None;
 
-        std::vector<utils::MiniFunction<void(void)>> m_mainThreadQueue;
-        mutable std::mutex m_mainThreadMutex;
+        // tasks are only ever moved once queued, so the queue doesn't need 
+        // them to be copyable like the public ScheduledFunction does
+        using MainThreadTask = utils::MoveOnlyMiniFunction<void()>;
+        // one lane per TaskPriority
+        static constexpr size_t MAIN_THREAD_LANE_COUNT = 3;
+        std::array<MPSCQueue<MainThreadTask>, MAIN_THREAD_LANE_COUNT> m_mainThreadQueues;
+        // tasks taken from the queues that didn't fit in the previous frame
+        std::array<std::deque<MainThreadTask>, MAIN_THREAD_LANE_COUNT> m_mainThreadCarryOver;
+        std::chrono::microseconds m_mainThreadBudget = std::chrono::milliseconds(8);
+        std::atomic_size_t m_mainThreadQueueSize = 0;
+        std::chrono::microseconds m_lastMainThreadDrainTime {0};
+        size_t m_lastMainThreadDrainCount = 0;
         std::vector<std::pair<Hook*, Mod*>> m_uninitializedHooks;
         bool m_readyToHook = false;
 
@@ -98,10 +134,19 @@ namespace geode {
         VersionInfo maxModVersion();
         bool isModVersionSupported(VersionInfo const& version);
 
+        void loadModMetadataCache();
+        void saveModMetadataCache();
         void queueMods(std::vector<ModMetadata>& modQueue);
         void populateModList(std::vector<ModMetadata>& modQueue);
         void buildModGraph();
-        void loadModGraph(Mod* node, bool early);
+        void buildLoadLevels();
+        bool canLoadMod(Mod* node);
+        void loadModBinary(Mod* node);
+        void loadEarlyMods();
+        void queueLoadLevel(std::vector<Mod*> const& level);
+        void loadUnzippedMods();
+        bool continueLoadLevels();
+        void logModLoadTimings();
         void findProblems();
         void refreshModGraph();
         void continueRefreshModGraph();
@@ -123,8 +168,9 @@ namespace geode {
 
         void updateResources(bool forceReload);
 
-        void queueInMainThread(const ScheduledFunction& func);
+        void queueInMainThread(MainThreadTask func, TaskPriority priority = TaskPriority::Normal);
         void executeMainThreadQueue();
+        MainThreadQueueStats getMainThreadQueueStats() const;
 
         bool isReadyToHook() const;
         void addUninitializedHook(Hook* hook, Mod* mod);
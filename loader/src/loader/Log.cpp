@@ -1,15 +1,21 @@
 #include "console.hpp"
+#include "BinaryLog.hpp"
 #include "LogImpl.hpp"
+#include "ModImpl.hpp"
 
 #include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Loader.hpp>
 #include <Geode/loader/Log.hpp>
 #include <Geode/loader/Mod.hpp>
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/general.hpp>
+#include <Geode/utils/string.hpp>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <iomanip>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 using namespace geode::prelude;
@@ -89,13 +95,126 @@ std::string cocos2d::format_as(cocos2d::ccColor4B const& col) {
     return fmt::format("rgba({}, {}, {}, {})", col.r, col.g, col.b, col.a);
 }
 
+// Levels
+
+std::atomic<Severity::type> log::impl::lowestLevel = Severity::Debug;
+
+namespace {
+    struct Levels {
+        std::mutex mutex;
+        std::atomic<Severity::type> global = Severity::Debug;
+        // from the "mod-log-levels" setting
+        std::unordered_map<std::string, Severity::type> configured;
+        // mods that have their own level set
+        std::unordered_map<Mod*, Severity::type> mods;
+
+        static Levels& get() {
+            // leaked since mods may still be logging during static destruction
+            static auto inst = new Levels();
+            return *inst;
+        }
+
+        // caller needs to hold the mutex
+        void updateLowest() {
+            auto lowest = global.load(std::memory_order_relaxed);
+            for (auto& [_, level] : mods) {
+                lowest = std::min(lowest, level);
+            }
+            log::impl::lowestLevel.store(lowest, std::memory_order_relaxed);
+        }
+    };
+}
+
+static std::optional<Severity> parseSeverity(std::string level) {
+    utils::string::trimIP(level);
+    utils::string::toLowerIP(level);
+    if (level == "debug") return Severity::Debug;
+    if (level == "info") return Severity::Info;
+    if (level == "warn" || level == "warning") return Severity::Warning;
+    if (level == "error") return Severity::Error;
+    return std::nullopt;
+}
+
+Severity log::getLogLevel() {
+    return Levels::get().global.load(std::memory_order_relaxed);
+}
+
+bool log::shouldLog(Severity sev, Mod* mod) {
+    auto impl = ModImpl::getImpl(mod);
+    return impl->isLoggingEnabled() && sev.m_value >= impl->getLogLevel().m_value;
+}
+
+void log::applyLevelSettings() {
+    auto& levels = Levels::get();
+    std::unique_lock lock(levels.mutex);
+
+    auto global = Mod::get()->getSettingValue<std::string>("log-level");
+    if (auto level = parseSeverity(global)) {
+        levels.global.store(level->m_value, std::memory_order_relaxed);
+    }
+
+    // formatted as "mod.id=level, other.mod=level"
+    levels.configured.clear();
+    for (auto& entry : utils::string::split(Mod::get()->getSettingValue<std::string>("mod-log-levels"), ",")) {
+        auto sep = entry.find('=');
+        if (sep == std::string::npos) {
+            continue;
+        }
+        auto level = parseSeverity(entry.substr(sep + 1));
+        if (!level) {
+            continue;
+        }
+        levels.configured.insert({ utils::string::trim(entry.substr(0, sep)), level->m_value });
+    }
+    levels.updateLowest();
+
+    // mods lock the levels themselves when their level changes
+    auto configured = levels.configured;
+    lock.unlock();
+
+    for (auto mod : Loader::get()->getAllMods()) {
+        // levels mods set for themselves are kept separately and still 
+        // take priority
+        auto it = configured.find(mod->getID());
+        if (it != configured.end()) {
+            ModImpl::getImpl(mod)->setConfiguredLogLevel(Severity::cast(it->second));
+        }
+        else {
+            ModImpl::getImpl(mod)->setConfiguredLogLevel(std::nullopt);
+        }
+    }
+}
+
+std::optional<Severity> log::getConfiguredLevel(std::string const& modID) {
+    auto& levels = Levels::get();
+    std::lock_guard lock(levels.mutex);
+    auto it = levels.configured.find(modID);
+    if (it == levels.configured.end()) {
+        return std::nullopt;
+    }
+    return Severity::cast(it->second);
+}
+
+void log::updateModLevel(Mod* mod, std::optional<Severity> level) {
+    auto& levels = Levels::get();
+    std::lock_guard lock(levels.mutex);
+    if (level) {
+        levels.mods.insert_or_assign(mod, level->m_value);
+    }
+    else {
+        levels.mods.erase(mod);
+    }
+    levels.updateLowest();
+}
+
 // Log
 
 inline static thread_local int32_t s_nestLevel = 0;
 inline static thread_local int32_t s_nestCountOffset = 0;
 
 void log::vlogImpl(Severity sev, Mod* mod, fmt::string_view format, fmt::format_args args) {
-    if (!mod->isLoggingEnabled()) return;
+    // logImpl already checks this, but this may also be called directly
+    if (!shouldLog(sev, mod)) return;
 
     auto nestCount = s_nestLevel * 2;
     if (nestCount != 0) {
@@ -204,45 +323,145 @@ Severity Log::getSeverity() const {
     return m_severity;
 }
 
+log_clock::time_point Log::getTime() const {
+    return m_time;
+}
+
+std::string const& Log::getThread() const {
+    return m_thread;
+}
+
+std::string const& Log::getSource() const {
+    return m_source;
+}
+
+std::string const& Log::getContent() const {
+    return m_content;
+}
+
 // Logger
 
+Logger::Logger() = default;
+Logger::~Logger() = default;
+
 Logger* Logger::get() {
-    static Logger inst;
-    return &inst;
+    // intentionally leaked, the writer thread may still be running when 
+    // static destructors are called
+    static auto inst = new Logger();
+    return inst;
 }
 
 void Logger::setup() {
     m_logStream = std::ofstream(dirs::getGeodeLogDir() / log::generateLogName());
+    m_setup = true;
+
+    std::thread([this] {
+        thread::setName("Log Writer");
+        this->writeLoop();
+    }).detach();
+
+    // the writer thread may not get to finish its last batch before exit
+    std::atexit([] {
+        Logger::get()->flush();
+    });
 }
 
-std::mutex& getLogMutex() {
-    static std::mutex mutex;
-    return mutex;
+Result<> Logger::setupBinaryLog(size_t maxSegmentSize, size_t maxSegmentCount) {
+    auto sessionName = ghc::filesystem::path(log::generateLogName()).stem().string();
+    GEODE_UNWRAP_INTO(auto sink, BinaryLogSink::create(
+        dirs::getGeodeLogDir() / "binary", sessionName, maxSegmentSize, maxSegmentCount
+    ));
+
+    std::lock_guard lock(m_consumerMutex);
+    // everything logged before this still goes to the text log
+    this->writePending();
+    m_logStream.close();
+    m_binarySink = std::move(sink);
+    return Ok();
 }
 
 void Logger::push(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
     std::string&& content) {
-    std::lock_guard g(getLogMutex());
+    m_queue.push(Log(sev, std::move(thread), std::move(source), nestCount, std::move(content)));
+
+    // only wake the writer once per batch
+    if (!m_wakeRequested.exchange(true, std::memory_order_acq_rel)) {
+        m_wakeCV.notify_one();
+    }
+}
 
-    Log& log = m_logs.emplace_back(sev, std::move(thread), std::move(source), nestCount,
-            std::move(content));
+void Logger::writeLoop() {
+    while (true) {
+        {
+            std::unique_lock lock(m_wakeMutex);
+            // the timeout covers a wake request that came in right before waiting
+            m_wakeCV.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return m_wakeRequested.load(std::memory_order_acquire);
+            });
+        }
+        m_wakeRequested.store(false, std::memory_order_release);
 
-    auto const logStr = log.toString();
-    console::log(logStr, log.getSeverity());
-    m_logStream << logStr << std::endl;
+        std::lock_guard lock(m_consumerMutex);
+        this->writePending();
+    }
+}
+
+bool Logger::writePending() {
+    if (!m_setup) {
+        return false;
+    }
+    Log log;
+    bool wrote = false;
+    while (m_queue.pop(log)) {
+        auto const logStr = log.toString();
+        console::log(logStr, log.getSeverity());
+        if (m_binarySink) {
+            m_binarySink->write(log);
+        }
+        else {
+            m_logStream << logStr << '\n';
+        }
+
+        std::lock_guard g(m_historyMutex);
+        if (m_history.size() >= MAX_HISTORY) {
+            m_history.pop_front();
+        }
+        m_history.push_back(std::move(log));
+        wrote = true;
+    }
+    // one flush per batch instead of per line
+    if (wrote) {
+        if (m_binarySink) {
+            m_binarySink->flush();
+        }
+        else {
+            m_logStream.flush();
+        }
+    }
+    return wrote;
+}
+
+void Logger::flush() {
+    // the writer thread may have died while holding the lock if this is 
+    // called from a crash handler, in which case there's nothing to do
+    std::unique_lock lock(m_consumerMutex, std::defer_lock);
+    if (lock.try_lock_for(std::chrono::seconds(1))) {
+        this->writePending();
+    }
 }
 
 Nest::Nest(std::shared_ptr<Nest::Impl> impl) : m_impl(std::move(impl)) { }
 Nest::Impl::Impl(int32_t nestLevel, int32_t nestCountOffset) :
     m_nestLevel(nestLevel), m_nestCountOffset(nestCountOffset) { }
 
-std::vector<Log> const& Logger::list() {
-    return m_logs;
+std::vector<Log> Logger::list() {
+    std::lock_guard g(m_historyMutex);
+    return std::vector<Log>(m_history.begin(), m_history.end());
 }
 
 void Logger::clear() {
-    std::lock_guard g(getLogMutex());
-    m_logs.clear();
+    std::lock_guard g(m_historyMutex);
+    m_history.clear();
 }
 
 // Misc
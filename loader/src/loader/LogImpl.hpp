@@ -3,8 +3,15 @@
 #include <Geode/DefaultInclude.hpp>
 #include <Geode/loader/Log.hpp>
 #include <Geode/loader/Mod.hpp>
+#include "MPSCQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 
 namespace geode::log {
@@ -18,29 +25,88 @@ namespace geode::log {
 
     public:
         ~Log();
+        Log() : m_severity(Severity::Debug), m_nestCount(0) {}
+        Log(Log const&) = default;
+        Log(Log&&) = default;
+        Log& operator=(Log const&) = default;
+        Log& operator=(Log&&) = default;
         Log(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
             std::string&& content);
 
         [[nodiscard]] std::string toString() const;
 
         [[nodiscard]] Severity getSeverity() const;
+        [[nodiscard]] log_clock::time_point getTime() const;
+        [[nodiscard]] std::string const& getThread() const;
+        [[nodiscard]] std::string const& getSource() const;
+        [[nodiscard]] std::string const& getContent() const;
     };
 
+    class BinaryLogSink;
+
+    /**
+     * Logs are pushed into a lock-free queue and formatted, printed and
+     * written to the log file in batches by a dedicated writer thread, so
+     * logging never blocks the thread it's called from
+     */
     class Logger {
     private:
-        std::vector<Log> m_logs;
+        // amount of logs kept in memory for the console
+        static constexpr size_t MAX_HISTORY = 2000;
+
+        MPSCQueue<Log> m_queue;
+        // only one thread may pop from the queue at a time, which is 
+        // usually the writer thread but can also be a thread flushing
+        std::timed_mutex m_consumerMutex;
+
+        std::atomic_bool m_wakeRequested = false;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCV;
+
+        std::deque<Log> m_history;
+        std::mutex m_historyMutex;
+
         std::ofstream m_logStream;
+        // replaces the text log file when enabled
+        std::unique_ptr<BinaryLogSink> m_binarySink;
+        bool m_setup = false;
+
+        Logger();
+        ~Logger();
+
+        void writeLoop();
+        // caller needs to hold the consumer mutex
+        bool writePending();
 
-        Logger() = default;
     public:
         static Logger* get();
 
+        /**
+         * Open the log file and start the writer thread
+         */
         void setup();
 
+        /**
+         * Switch from the text log file to a binary log
+         * @param maxSegmentSize Segment size in bytes after which a new 
+         * segment is started
+         * @param maxSegmentCount Amount of segments kept around
+         */
+        Result<> setupBinaryLog(size_t maxSegmentSize, size_t maxSegmentCount);
+
         void push(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
             std::string&& content);
 
-        std::vector<Log> const& list();
+        /**
+         * Write all pushed logs on the calling thread. Used on exit and when 
+         * crashing, where the writer thread may not get to run anymore
+         */
+        void flush();
+
+        /**
+         * Get the most recent logs, up to MAX_HISTORY of them
+         */
+        std::vector<Log> list();
         void clear();
     };
 
@@ -50,4 +116,21 @@ namespace geode::log {
         int32_t m_nestCountOffset;
         Impl(int32_t nestLevel, int32_t nestCountOffset);
     };
+
+    /**
+     * Read the "log-level" and "mod-log-levels" settings of the loader and 
+     * apply them to all mods
+     */
+    void applyLevelSettings();
+
+    /**
+     * Get the level set for a mod in the "mod-log-levels" setting, if any
+     */
+    std::optional<Severity> getConfiguredLevel(std::string const& modID);
+
+    /**
+     * Keep track of a mod's own level for working out the lowest level that 
+     * is shown for any mod
+     */
+    void updateModLevel(Mod* mod, std::optional<Severity> level);
 }
@@ -48,6 +48,30 @@ matjson::Value& Mod::getSaveContainer() {
     return m_impl->getSaveContainer();
 }
 
+matjson::Value const& Mod::getSaveContainer() const {
+    return m_impl->readSaveContainer();
+}
+
+size_t const& Mod::getSaveContainerRevision() const {
+    return m_impl->m_savedRevision;
+}
+
+SavedValueFormat Mod::getSavedValueFormat() const {
+    return m_impl->getSavedValueFormat();
+}
+
+void Mod::setSavedValueFormat(SavedValueFormat format) {
+    m_impl->setSavedValueFormat(format);
+}
+
+Result<> Mod::exportSavedValues(ghc::filesystem::path const& path) const {
+    return m_impl->exportSavedValues(path);
+}
+
+Result<> Mod::importSavedValues(ghc::filesystem::path const& path) {
+    return m_impl->importSavedValues(path);
+}
+
 matjson::Value& Mod::getSavedSettingsData() {
     return m_impl->getSavedSettingsData();
 }
@@ -230,8 +254,16 @@ void Mod::setLoggingEnabled(bool enabled) {
     m_impl->setLoggingEnabled(enabled);
 }
 
+Severity Mod::getLogLevel() const {
+    return m_impl->getLogLevel();
+}
+
+void Mod::setLogLevel(std::optional<Severity> level) {
+    m_impl->setLogLevel(level);
+}
+
 bool Mod::hasSavedValue(std::string_view const key) {
-    return this->getSaveContainer().contains(key);
+    return std::as_const(*this).getSaveContainer().contains(key);
 }
 
 bool Mod::hasProblems() const {
@@ -2,6 +2,10 @@
 
 using namespace geode::prelude;
 
+static size_t getModStateKey(Mod* mod, ModEventType type) {
+    return reinterpret_cast<size_t>(mod) * 31 + static_cast<size_t>(type);
+}
+
 ModStateEvent::ModStateEvent(Mod* mod, ModEventType type) : m_mod(mod), m_type(type) {}
 
 ModEventType ModStateEvent::getType() const {
@@ -12,6 +16,10 @@ Mod* ModStateEvent::getMod() const {
     return m_mod;
 }
 
+std::optional<size_t> ModStateEvent::getFilterKey() const {
+    return getModStateKey(m_mod, m_type);
+}
+
 ListenerResult ModStateFilter::handle(utils::MiniFunction<Callback> fn, ModStateEvent* event) {
     // log::debug("Event mod filter: {}, {}, {}, {}", m_mod, static_cast<int>(m_type), event->getMod(), static_cast<int>(event->getType()));
     if ((!m_mod || event->getMod() == m_mod) && event->getType() == m_type) {
@@ -20,4 +28,12 @@ ListenerResult ModStateFilter::handle(utils::MiniFunction<Callback> fn, ModState
     return ListenerResult::Propagate;
 }
 
+std::optional<size_t> ModStateFilter::getKey() const {
+    // listeners for all mods need to see every event
+    if (!m_mod) {
+        return std::nullopt;
+    }
+    return getModStateKey(m_mod, m_type);
+}
+
 ModStateFilter::ModStateFilter(Mod* mod, ModEventType type) : m_mod(mod), m_type(type) {}
@@ -5,6 +5,8 @@
 #include "PatchImpl.hpp"
 #include "about.hpp"
 #include "console.hpp"
+#include "AsyncFileWriter.hpp"
+#include "LogImpl.hpp"
 
 #include <hash/hash.hpp>
 #include <Geode/loader/Dirs.hpp>
@@ -15,6 +17,7 @@
 #include <Geode/loader/ModEvent.hpp>
 #include <Geode/utils/file.hpp>
 #include <Geode/utils/JsonValidation.hpp>
+#include <chrono>
 #include <optional>
 #include <string>
 #include <vector>
@@ -42,6 +45,9 @@ Result<> Mod::Impl::setup() {
     GEODE_UNWRAP(this->createTempDir().expect("Unable to create temp dir: {error}"));
 
     this->setupSettings();
+    if (auto level = log::getConfiguredLevel(m_metadata.getID())) {
+        this->setConfiguredLogLevel(level);
+    }
     auto loadRes = this->loadData();
     if (!loadRes) {
         log::warn("Unable to load data for \"{}\": {}", m_metadata.getID(), loadRes.unwrapErr());
@@ -116,10 +122,85 @@ VersionInfo Mod::Impl::getVersion() const {
 }
 
 matjson::Value& Mod::Impl::getSaveContainer() {
+    this->loadSavedValues();
+    m_savedDirty = true;
+    m_savedRevision += 1;
+    return m_saved;
+}
+
+matjson::Value const& Mod::Impl::readSaveContainer() {
+    this->loadSavedValues();
     return m_saved;
 }
 
+void Mod::Impl::loadSavedValues() {
+    if (m_savedLoaded) {
+        return;
+    }
+    m_savedLoaded = true;
+    m_savedRevision += 1;
+
+    auto res = m_savedStore->load();
+    if (!res) {
+        log::error("Unable to load saved values: {}", res.unwrapErr());
+        // the next save would replace the file with only the values set from 
+        // now on, so keep a copy of it around
+        auto path = m_savedStore->getPath();
+        auto backupPath = path;
+        backupPath += fmt::format(
+            ".{}.bak",
+            std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()
+            ).count()
+        );
+        std::error_code ec;
+        ghc::filesystem::rename(path, backupPath, ec);
+        if (ec) {
+            log::error("Unable to move unreadable saved values aside, they won't be saved: {}", ec.message());
+            m_savedUnreadable = true;
+        }
+        else {
+            log::warn("Moved unreadable saved values to {}", backupPath.filename().string());
+        }
+        return;
+    }
+    m_saved = std::move(res.unwrap());
+}
+
+SavedValueFormat Mod::Impl::getSavedValueFormat() const {
+    return m_savedStore ? SavedValueFormat::Binary : SavedValueFormat::Json;
+}
+
+void Mod::Impl::setSavedValueFormat(SavedValueFormat format) {
+    if (format == this->getSavedValueFormat()) {
+        return;
+    }
+    this->loadSavedValues();
+    if (format == SavedValueFormat::Binary) {
+        m_savedStore = std::make_unique<SavedValueStore>(m_saveDirPath / SavedValueStore::FILE_NAME);
+    }
+    else {
+        m_savedStore.reset();
+    }
+    m_savedFormatChanged = !m_savedFormatChanged;
+    m_savedDirty = true;
+}
+
+Result<> Mod::Impl::exportSavedValues(ghc::filesystem::path const& path) {
+    return utils::file::writeStringSafe(path, this->readSaveContainer().dump());
+}
+
+Result<> Mod::Impl::importSavedValues(ghc::filesystem::path const& path) {
+    GEODE_UNWRAP_INTO(auto json, utils::file::readJson(path));
+    if (!json.is_object()) {
+        return Err("Saved values have to be an object");
+    }
+    this->getSaveContainer() = std::move(json);
+    return Ok();
+}
+
 matjson::Value& Mod::Impl::getSavedSettingsData() {
+    m_settingsDirty = true;
     return m_savedSettingsData;
 }
 
@@ -207,8 +288,14 @@ Result<> Mod::Impl::loadData() {
     }
 
     // Saved values
+    auto storePath = m_saveDirPath / SavedValueStore::FILE_NAME;
     auto savedPath = m_saveDirPath / "saved.json";
-    if (ghc::filesystem::exists(savedPath)) {
+    if (ghc::filesystem::exists(storePath)) {
+        m_savedStore = std::make_unique<SavedValueStore>(storePath);
+        m_savedLoaded = false;
+        m_savedRevision += 1;
+    }
+    else if (ghc::filesystem::exists(savedPath)) {
         GEODE_UNWRAP_INTO(auto data, utils::file::readString(savedPath));
         std::string error;
         auto res = matjson::parse(data, error);
@@ -216,6 +303,7 @@ Result<> Mod::Impl::loadData() {
             return Err("Unable to parse saved values: " + error);
         }
         m_saved = res.value();
+        m_savedRevision += 1;
         if (!m_saved.is_object()) {
             log::warn("saved.json was somehow not an object, forcing it to one");
             m_saved = matjson::Object();
@@ -226,47 +314,105 @@ Result<> Mod::Impl::loadData() {
 }
 
 Result<> Mod::Impl::saveData() {
-    // saveData is expected to be synchronous, and always called from GD thread
-    ModStateEvent(m_self, ModEventType::DataSaved).post();
-
-    // Data saving should be fully fail-safe
+    m_savedDirty = true;
+    m_settingsDirty = true;
+    return this->saveChangedData();
+}
 
-    std::unordered_set<std::string> coveredSettings;
+Result<> Mod::Impl::saveChangedData() {
+    // always called from GD thread. listeners may still change saved values
+    // in response to this, so it has to be posted before checking for changes
+    ModStateEvent(m_self, ModEventType::DataSaved).post();
 
-    // Settings
-    matjson::Value json = matjson::Object();
-    for (auto& [key, value] : m_settings) {
-        coveredSettings.insert(key);
-        if (!value->save(json[key])) {
-            log::error("Unable to save setting \"{}\"", key);
+    // Data saving should be fully fail-safe. Files are only serialized and
+    // written on the writer thread, which replaces them atomically. If a 
+    // write fails, the data is marked as changed again so the next save 
+    // retries it
+    auto onFailure = [this](auto markDirty) -> AsyncFileWriter::FailureCallback {
+        return [this, markDirty]() {
+            Loader::get()->queueInMainThread([this, markDirty]() {
+                markDirty(this);
+            });
+        };
+    };
+
+    if (m_settingsDirty) {
+        m_settingsDirty = false;
+
+        std::unordered_set<std::string> coveredSettings;
+
+        // Settings
+        matjson::Value json = matjson::Object();
+        for (auto& [key, value] : m_settings) {
+            coveredSettings.insert(key);
+            if (!value->save(json[key])) {
+                log::error("Unable to save setting \"{}\"", key);
+            }
         }
-    }
 
-    // if some settings weren't provided a custom settings handler (for example,
-    // the mod was not loaded) then make sure to save their previous state in
-    // order to not lose data
-    log::debug("Check covered");
-    if (!m_savedSettingsData.is_object()) {
-        m_savedSettingsData = matjson::Object();
-    }
-    for (auto& [key, value] : m_savedSettingsData.as_object()) {
-        log::debug("Check if {} is saved", key);
-        if (!coveredSettings.contains(key)) {
-            json[key] = value;
+        // if some settings weren't provided a custom settings handler (for example,
+        // the mod was not loaded) then make sure to save their previous state in
+        // order to not lose data
+        if (!m_savedSettingsData.is_object()) {
+            m_savedSettingsData = matjson::Object();
+        }
+        for (auto& [key, value] : m_savedSettingsData.as_object()) {
+            if (!coveredSettings.contains(key)) {
+                json[key] = value;
+            }
         }
-    }
-
-    std::string settingsStr = json.dump();
-    std::string savedStr = m_saved.dump();
 
-    auto res = utils::file::writeString(m_saveDirPath / "settings.json", settingsStr);
-    if (!res) {
-        log::error("Unable to save settings: {}", res.unwrapErr());
-    }
+        AsyncFileWriter::get()->write(m_saveDirPath / "settings.json", [json = std::move(json)]() {
+            return json.dump();
+        }, onFailure([](Mod::Impl* impl) {
+            impl->m_settingsDirty = true;
+        }));
+    }
+
+    if (m_savedDirty) {
+        m_savedDirty = false;
+
+        if (m_savedStore) {
+            // saveData marks values dirty without reading them, and nothing 
+            // can have changed if they were never loaded. saving the empty 
+            // container would rewrite the file without any of its records
+            if (m_savedLoaded && !m_savedUnreadable) {
+                // the store thinks the failed records were written, so it 
+                // has to write everything again
+                m_savedStore->save(m_saved, onFailure([](Mod::Impl* impl) {
+                    impl->m_savedDirty = true;
+                    if (impl->m_savedStore) {
+                        impl->m_savedStore->forceRewrite();
+                    }
+                }));
+            }
+        }
+        else {
+            // copied since the mod may keep changing its values while this 
+            // is being written
+            AsyncFileWriter::get()->write(m_saveDirPath / "saved.json", [saved = m_saved]() {
+                return saved.dump();
+            }, onFailure([](Mod::Impl* impl) {
+                impl->m_savedDirty = true;
+            }));
+        }
 
-    auto res2 = utils::file::writeString(m_saveDirPath / "saved.json", savedStr);
-    if (!res2) {
-        log::error("Unable to save values: {}", res2.unwrapErr());
+        // a leftover saved.bin would be loaded instead of saved.json, and a 
+        // leftover saved.json would just be stale
+        if (m_savedFormatChanged && !m_savedUnreadable) {
+            m_savedFormatChanged = false;
+            auto oldPath = m_savedStore ?
+                m_saveDirPath / "saved.json" :
+                m_saveDirPath / SavedValueStore::FILE_NAME;
+            AsyncFileWriter::get()->update(oldPath, [oldPath]() -> Result<> {
+                std::error_code ec;
+                ghc::filesystem::remove(oldPath, ec);
+                if (ec) {
+                    return Err("Unable to remove file: {}", ec.message());
+                }
+                return Ok();
+            });
+        }
     }
 
     return Ok();
@@ -664,38 +810,42 @@ Result<> Mod::Impl::unzipGeodeFile(ModMetadata metadata) {
     }
     log::debug("Hash mismatch detected, unzipping");
 
-    std::error_code ec;
-    ghc::filesystem::remove_all(tempDir, ec);
-    if (ec) {
-        auto message = ec.message();
-        #ifdef GEODE_IS_WINDOWS
-            // Force the error message into English
-            char* errorBuf = nullptr;
-            FormatMessageA(
-                FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_IGNORE_INSERTS,
-                nullptr, ec.value(), MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US), (LPSTR)&errorBuf, 0, nullptr);
-            if (errorBuf) {
-                message = errorBuf;
-                LocalFree(errorBuf);
-            }
-        #endif
-        return Err("Unable to delete temp dir: " + message);
-    }
-
-    (void)utils::file::createDirectoryAll(tempDir);
-    auto res = file::writeString(datePath, modifiedHash);
-    if (!res) {
-        log::warn("Failed to write modified date of geode zip: {}", res.unwrapErr());
-    }
-
-
     GEODE_UNWRAP_INTO(auto unzip, file::Unzip::create(metadata.getPath()));
     if (!unzip.hasEntry(metadata.getBinaryName())) {
         return Err(
             fmt::format("Unable to find platform binary under the name \"{}\"", metadata.getBinaryName())
         );
     }
-    GEODE_UNWRAP(unzip.extractAllTo(tempDir));
+
+    // only entries that changed since the last unzip get extracted, so the 
+    // directory is only wiped if it's from before extraction was tracked
+    if (ghc::filesystem::exists(tempDir) && !ghc::filesystem::exists(tempDir / ".extract-manifest.json")) {
+        std::error_code ec;
+        ghc::filesystem::remove_all(tempDir, ec);
+        if (ec) {
+            auto message = ec.message();
+            #ifdef GEODE_IS_WINDOWS
+                // Force the error message into English
+                char* errorBuf = nullptr;
+                FormatMessageA(
+                    FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_IGNORE_INSERTS,
+                    nullptr, ec.value(), MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US), (LPSTR)&errorBuf, 0, nullptr);
+                if (errorBuf) {
+                    message = errorBuf;
+                    LocalFree(errorBuf);
+                }
+            #endif
+            return Err("Unable to delete temp dir: " + message);
+        }
+    }
+
+    GEODE_UNWRAP(unzip.extractChangedTo(tempDir));
+
+    // only mark the zip as unzipped once everything is actually there
+    auto res = file::writeString(datePath, modifiedHash);
+    if (!res) {
+        log::warn("Failed to write modified date of geode zip: {}", res.unwrapErr());
+    }
 
     return Ok();
 }
@@ -751,6 +901,37 @@ void Mod::Impl::setLoggingEnabled(bool enabled) {
     m_loggingEnabled = enabled;
 }
 
+Severity Mod::Impl::getLogLevel() const {
+    auto level = m_logLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = m_configuredLogLevel.load(std::memory_order_relaxed);
+    }
+    return level < 0 ? log::getLogLevel() : Severity::cast(level);
+}
+
+void Mod::Impl::setLogLevel(std::optional<Severity> level) {
+    m_logLevel.store(level ? level->m_value : -1, std::memory_order_relaxed);
+    this->updateLogLevel();
+}
+
+void Mod::Impl::setConfiguredLogLevel(std::optional<Severity> level) {
+    m_configuredLogLevel.store(level ? level->m_value : -1, std::memory_order_relaxed);
+    this->updateLogLevel();
+}
+
+void Mod::Impl::updateLogLevel() {
+    auto level = m_logLevel.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = m_configuredLogLevel.load(std::memory_order_relaxed);
+    }
+    if (level < 0) {
+        log::updateModLevel(m_self, std::nullopt);
+    }
+    else {
+        log::updateModLevel(m_self, Severity::cast(level));
+    }
+}
+
 bool Mod::Impl::shouldLoad() const {
     return Mod::get()->getSavedValue<bool>("should-load-" + m_metadata.getID(), true);
 }
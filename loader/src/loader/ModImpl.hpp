@@ -2,7 +2,9 @@
 
 #include <matjson.hpp>
 #include "ModPatch.hpp"
+#include "SavedValueStore.hpp"
 #include <Geode/loader/Loader.hpp>
+#include <atomic>
 
 namespace geode {
     class Mod::Impl {
@@ -54,6 +56,35 @@ namespace geode {
          * Settings save data. Stored for efficient loading of custom settings
          */
         matjson::Value m_savedSettingsData = matjson::Object();
+        /**
+         * Whether the saved values or settings have changed since they were 
+         * last saved
+         */
+        bool m_savedDirty = false;
+        bool m_settingsDirty = false;
+        /**
+         * Changed whenever the saved values may have been modified, so 
+         * SavedValueHandles know when to update
+         */
+        size_t m_savedRevision = 0;
+        /**
+         * Store the saved values are kept in if they're in the binary format
+         */
+        std::unique_ptr<SavedValueStore> m_savedStore;
+        /**
+         * Binary saved values are only read once they're first used
+         */
+        bool m_savedLoaded = true;
+        /**
+         * Set if the binary saved values couldn't be read or moved out of 
+         * the way, in which case they're never written to avoid losing them
+         */
+        bool m_savedUnreadable = false;
+        /**
+         * Whether the file of the previous format has to be removed after 
+         * the saved value format was changed
+         */
+        bool m_savedFormatChanged = false;
         /**
          * Whether the mod resources are loaded or not
          */
@@ -62,6 +93,16 @@ namespace geode {
          * Whether logging is enabled for this mod
          */
         bool m_loggingEnabled = true;
+        /**
+         * Lowest severity of logs shown for this mod as set by the mod 
+         * itself, or -1 to use the configured level
+         */
+        std::atomic<int> m_logLevel = -1;
+        /**
+         * Level from the loader's "mod-log-levels" setting, or -1 to use the 
+         * global level
+         */
+        std::atomic<int> m_configuredLogLevel = -1;
 
         std::unordered_map<std::string, char const*> m_expandedSprites;
 
@@ -99,6 +140,12 @@ namespace geode {
         ghc::filesystem::path getBinaryPath() const;
 
         matjson::Value& getSaveContainer();
+        matjson::Value const& readSaveContainer();
+        void loadSavedValues();
+        SavedValueFormat getSavedValueFormat() const;
+        void setSavedValueFormat(SavedValueFormat format);
+        Result<> exportSavedValues(ghc::filesystem::path const& path);
+        Result<> importSavedValues(ghc::filesystem::path const& path);
         matjson::Value& getSavedSettingsData();
 
 #if defined(GEODE_EXPOSE_SECRET_INTERNALS_IN_HEADERS_DO_NOT_DEFINE_PLEASE)
@@ -107,6 +154,10 @@ namespace geode {
 #endif
 
         Result<> saveData();
+        /**
+         * Save only the data that has changed since it was last saved
+         */
+        Result<> saveChangedData();
         Result<> loadData();
 
         ghc::filesystem::path getSaveDir() const;
@@ -153,6 +204,10 @@ namespace geode {
 
         bool isLoggingEnabled() const;
         void setLoggingEnabled(bool enabled);
+        Severity getLogLevel() const;
+        void setLogLevel(std::optional<Severity> level);
+        void setConfiguredLogLevel(std::optional<Severity> level);
+        void updateLogLevel();
 
         std::vector<LoadProblem> getProblems() const;
 
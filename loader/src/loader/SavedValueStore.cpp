@@ -0,0 +1,412 @@
+#include "SavedValueStore.hpp"
+#include "AsyncFileWriter.hpp"
+
+#include <Geode/utils/file.hpp>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#include <vector>
+#include <zlib.h>
+
+using namespace geode::prelude;
+
+static constexpr char MAGIC[4] = { 'G', 'S', 'V', 'S' };
+static constexpr uint16_t VERSION = 1;
+static constexpr size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(uint16_t);
+static constexpr size_t RECORD_HEADER_SIZE = sizeof(uint32_t) * 2;
+// logs smaller than this are never compacted
+static constexpr size_t MIN_COMPACT_SIZE = 64 * 1024;
+// deeper values are most likely a corrupted file
+static constexpr size_t MAX_DEPTH = 256;
+
+namespace {
+    enum class Tag : uint8_t {
+        Null,
+        False,
+        True,
+        Int,
+        Double,
+        String,
+        Array,
+        Object,
+    };
+
+    enum class Op : uint8_t {
+        Set = 1,
+        Erase = 2,
+    };
+}
+
+template <class T>
+static void writeRaw(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <class T>
+static bool readRaw(std::string_view& data, T& out) {
+    if (data.size() < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&out, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+}
+
+static void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static bool readVarint(std::string_view& data, uint64_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (data.empty()) {
+            return false;
+        }
+        auto byte = static_cast<uint8_t>(data.front());
+        data.remove_prefix(1);
+        out |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void writeString(std::string& out, std::string_view str) {
+    writeVarint(out, str.size());
+    out += str;
+}
+
+static bool readString(std::string_view& data, std::string& out) {
+    uint64_t length;
+    if (!readVarint(data, length) || length > data.size()) {
+        return false;
+    }
+    out.assign(data.data(), length);
+    data.remove_prefix(length);
+    return true;
+}
+
+static uint64_t hashBytes(std::string_view data) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+static std::string makeRecord(Op op, std::string const& key, matjson::Value const* value) {
+    std::string body;
+    body.push_back(static_cast<char>(op));
+    writeString(body, key);
+    if (value) {
+        SavedValueStore::encodeValue(*value, body);
+    }
+    std::string record;
+    record.reserve(RECORD_HEADER_SIZE + body.size());
+    writeRaw<uint32_t>(record, static_cast<uint32_t>(body.size()));
+    writeRaw<uint32_t>(record, static_cast<uint32_t>(
+        crc32(0, reinterpret_cast<Bytef const*>(body.data()), static_cast<uInt>(body.size()))
+    ));
+    record += body;
+    return record;
+}
+
+static std::string_view getRecordBody(std::string_view record) {
+    return record.substr(RECORD_HEADER_SIZE);
+}
+
+void SavedValueStore::encodeValue(matjson::Value const& value, std::string& out) {
+    switch (value.type()) {
+        default:
+        case matjson::Type::Null: {
+            out.push_back(static_cast<char>(Tag::Null));
+        } break;
+
+        case matjson::Type::Bool: {
+            out.push_back(static_cast<char>(value.as_bool() ? Tag::True : Tag::False));
+        } break;
+
+        case matjson::Type::Number: {
+            auto num = value.as_double();
+            // most saved numbers are integers, which are much smaller as
+            // varints. beyond 2^53 doubles can't represent every integer
+            if (std::trunc(num) == num && std::abs(num) < 9007199254740992.0 && !std::signbit(num)) {
+                out.push_back(static_cast<char>(Tag::Int));
+                writeVarint(out, static_cast<uint64_t>(num));
+            }
+            else {
+                out.push_back(static_cast<char>(Tag::Double));
+                writeRaw<double>(out, num);
+            }
+        } break;
+
+        case matjson::Type::String: {
+            out.push_back(static_cast<char>(Tag::String));
+            writeString(out, value.as_string());
+        } break;
+
+        case matjson::Type::Array: {
+            auto& arr = value.as_array();
+            out.push_back(static_cast<char>(Tag::Array));
+            writeVarint(out, arr.size());
+            for (auto& item : arr) {
+                encodeValue(item, out);
+            }
+        } break;
+
+        case matjson::Type::Object: {
+            auto& obj = value.as_object();
+            out.push_back(static_cast<char>(Tag::Object));
+            writeVarint(out, obj.size());
+            for (auto& [key, item] : obj) {
+                writeString(out, key);
+                encodeValue(item, out);
+            }
+        } break;
+    }
+}
+
+static Result<matjson::Value> decodeValueAt(std::string_view& data, size_t depth) {
+    if (depth > MAX_DEPTH) {
+        return Err("Value is nested too deeply");
+    }
+    uint8_t tag;
+    if (!readRaw(data, tag)) {
+        return Err("Unexpected end of value");
+    }
+    switch (static_cast<Tag>(tag)) {
+        case Tag::Null: return Ok(matjson::Value());
+        case Tag::False: return Ok(matjson::Value(false));
+        case Tag::True: return Ok(matjson::Value(true));
+
+        case Tag::Int: {
+            uint64_t num;
+            if (!readVarint(data, num)) {
+                return Err("Invalid integer");
+            }
+            return Ok(matjson::Value(static_cast<double>(num)));
+        }
+
+        case Tag::Double: {
+            double num;
+            if (!readRaw(data, num)) {
+                return Err("Invalid number");
+            }
+            return Ok(matjson::Value(num));
+        }
+
+        case Tag::String: {
+            std::string str;
+            if (!readString(data, str)) {
+                return Err("Invalid string");
+            }
+            return Ok(matjson::Value(std::move(str)));
+        }
+
+        case Tag::Array: {
+            uint64_t count;
+            // every item takes at least one byte
+            if (!readVarint(data, count) || count > data.size()) {
+                return Err("Invalid array");
+            }
+            matjson::Array arr;
+            arr.reserve(count);
+            for (uint64_t i = 0; i < count; i++) {
+                GEODE_UNWRAP_INTO(auto item, decodeValueAt(data, depth + 1));
+                arr.push_back(std::move(item));
+            }
+            return Ok(matjson::Value(std::move(arr)));
+        }
+
+        case Tag::Object: {
+            uint64_t count;
+            if (!readVarint(data, count) || count > data.size()) {
+                return Err("Invalid object");
+            }
+            matjson::Value obj = matjson::Object();
+            std::string key;
+            for (uint64_t i = 0; i < count; i++) {
+                if (!readString(data, key)) {
+                    return Err("Invalid object key");
+                }
+                GEODE_UNWRAP_INTO(auto item, decodeValueAt(data, depth + 1));
+                obj[key] = std::move(item);
+            }
+            return Ok(std::move(obj));
+        }
+
+        default: return Err("Unknown value type {}", tag);
+    }
+}
+
+Result<matjson::Value> SavedValueStore::decodeValue(std::string_view& data) {
+    return decodeValueAt(data, 0);
+}
+
+SavedValueStore::SavedValueStore(ghc::filesystem::path path) : m_path(std::move(path)) {}
+
+ghc::filesystem::path const& SavedValueStore::getPath() const {
+    return m_path;
+}
+
+Result<matjson::Value> SavedValueStore::load() {
+    m_persisted.clear();
+    m_fileSize = 0;
+    m_liveSize = HEADER_SIZE;
+    m_needsRewrite = true;
+
+    matjson::Value values = matjson::Object();
+    if (!ghc::filesystem::exists(m_path)) {
+        return Ok(std::move(values));
+    }
+    GEODE_UNWRAP_INTO(auto file, file::readString(m_path));
+
+    std::string_view data = file;
+    uint16_t version;
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return Err("Not a saved value store");
+    }
+    data.remove_prefix(sizeof(MAGIC));
+    (void)readRaw(data, version);
+    if (version > VERSION) {
+        return Err("Saved value store is from a newer version ({})", version);
+    }
+
+    // the latest value of each key, in the order the keys were first saved in
+    std::unordered_map<std::string, matjson::Value> latest;
+    std::vector<std::string> order;
+    std::unordered_set<std::string> seen;
+
+    size_t validSize = HEADER_SIZE;
+    std::string key;
+    while (!data.empty()) {
+        auto record = data;
+        uint32_t length, checksum;
+        if (!readRaw(record, length) || !readRaw(record, checksum) || length > record.size()) {
+            break;
+        }
+        auto body = record.substr(0, length);
+        if (crc32(0, reinterpret_cast<Bytef const*>(body.data()), static_cast<uInt>(body.size())) != checksum) {
+            break;
+        }
+        auto recordSize = RECORD_HEADER_SIZE + length;
+        auto rest = body;
+
+        uint8_t op;
+        if (!readRaw(rest, op) || !readString(rest, key)) {
+            break;
+        }
+        if (static_cast<Op>(op) == Op::Set) {
+            auto value = decodeValue(rest);
+            if (!value || !rest.empty()) {
+                break;
+            }
+            if (seen.insert(key).second) {
+                order.push_back(key);
+            }
+            latest.insert_or_assign(key, std::move(value.unwrap()));
+            m_persisted.insert_or_assign(key, Persisted { hashBytes(body), recordSize });
+        }
+        else if (static_cast<Op>(op) == Op::Erase) {
+            latest.erase(key);
+            m_persisted.erase(key);
+        }
+        else {
+            break;
+        }
+        data.remove_prefix(recordSize);
+        validSize += recordSize;
+    }
+
+    for (auto& k : order) {
+        auto it = latest.find(k);
+        if (it != latest.end()) {
+            values[k] = std::move(it->second);
+        }
+    }
+    for (auto& [_, persisted] : m_persisted) {
+        m_liveSize += persisted.size;
+    }
+    m_fileSize = validSize;
+    // anything after the last valid record has to be cut off before appending
+    m_needsRewrite = validSize != file.size();
+
+    return Ok(std::move(values));
+}
+
+void SavedValueStore::forceRewrite() {
+    m_needsRewrite = true;
+}
+
+void SavedValueStore::save(matjson::Value const& values, AsyncFileWriter::FailureCallback onFailure) {
+    if (!values.is_object()) {
+        return;
+    }
+
+    std::string full;
+    full.append(MAGIC, sizeof(MAGIC));
+    writeRaw<uint16_t>(full, VERSION);
+
+    std::string changes;
+    std::unordered_map<std::string, Persisted> persisted;
+    persisted.reserve(m_persisted.size());
+    for (auto& [key, value] : values.as_object()) {
+        auto record = makeRecord(Op::Set, key, &value);
+        auto hash = hashBytes(getRecordBody(record));
+        auto it = m_persisted.find(key);
+        if (it == m_persisted.end() || it->second.hash != hash) {
+            changes += record;
+        }
+        persisted.insert({ key, Persisted { hash, record.size() } });
+        full += record;
+    }
+    for (auto& [key, _] : m_persisted) {
+        if (!persisted.contains(key)) {
+            changes += makeRecord(Op::Erase, key, nullptr);
+        }
+    }
+    m_persisted = std::move(persisted);
+    m_liveSize = full.size();
+    m_fileSize += changes.size();
+
+    if (changes.empty() && !m_needsRewrite) {
+        return;
+    }
+
+    // rewrite the log once most of it is overwritten records
+    if (m_needsRewrite || (m_fileSize > MIN_COMPACT_SIZE && m_fileSize > m_liveSize * 2)) {
+        m_fileSize = m_liveSize;
+        m_needsRewrite = false;
+        AsyncFileWriter::get()->write(m_path, [full = std::move(full)]() {
+            return full;
+        }, std::move(onFailure));
+        return;
+    }
+
+    AsyncFileWriter::get()->update(m_path, [path = m_path, changes = std::move(changes)]() -> Result<> {
+        std::ofstream file;
+#if _WIN32
+        file.open(path.wstring(), std::ios::out | std::ios::binary | std::ios::app);
+#else
+        file.open(path.string(), std::ios::out | std::ios::binary | std::ios::app);
+#endif
+        if (!file.is_open()) {
+            return Err("Unable to open file");
+        }
+        file.write(changes.data(), changes.size());
+        file.flush();
+        if (!file) {
+            return Err("Unable to append to file");
+        }
+        return Ok();
+    }, std::move(onFailure));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AsyncFileWriter.hpp"
+
+#include <Geode/utils/Result.hpp>
+#include <ghc/fs_fwd.hpp>
+#include <matjson.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace geode {
+    /**
+     * Stores saved values as an append-only log of binary key/value records.
+     * Saving only appends the values that changed since the last save, and
+     * the log is compacted once most of it consists of overwritten records.
+     *
+     * File: char[4] magic, u16 version, then records of
+     *       u32 length, u32 crc32, u8 op, varint key length, key, value
+     * Values are encoded as a type tag followed by the value. Records with a
+     * bad checksum end the log, since they can only come from a crash while
+     * appending
+     */
+    class SavedValueStore final {
+    private:
+        struct Persisted {
+            uint64_t hash;
+            size_t size;
+        };
+
+        ghc::filesystem::path m_path;
+        // what each key's latest record looks like, for finding changed values
+        std::unordered_map<std::string, Persisted> m_persisted;
+        // size of the log file including overwritten records
+        size_t m_fileSize = 0;
+        // size the log file would be after compacting it
+        size_t m_liveSize = 0;
+        // whether the whole file has to be written instead of appended to
+        bool m_needsRewrite = true;
+
+    public:
+        static constexpr char const* FILE_NAME = "saved.bin";
+
+        explicit SavedValueStore(ghc::filesystem::path path);
+
+        ghc::filesystem::path const& getPath() const;
+
+        /**
+         * Read the values from the log
+         */
+        Result<matjson::Value> load();
+
+        /**
+         * Queue the values that changed since the last save to be written.
+         * The log is written on the data writer thread
+         * @param values Object with all saved values
+         */
+        void save(matjson::Value const& values, AsyncFileWriter::FailureCallback onFailure = nullptr);
+
+        /**
+         * Write the whole log on the next save, for example because the 
+         * last write failed and may have left a partial record behind
+         */
+        void forceRewrite();
+
+        static void encodeValue(matjson::Value const& value, std::string& out);
+        static Result<matjson::Value> decodeValue(std::string_view& data);
+    };
+}
@@ -1,4 +1,5 @@
 #include "../ui/internal/settings/GeodeSettingNode.hpp"
+#include "ModImpl.hpp"
 
 #include <Geode/loader/Mod.hpp>
 #include <Geode/loader/Setting.hpp>
@@ -252,6 +253,9 @@ std::string SettingValue::getModID() const {
 }
 
 void SettingValue::valueChanged() {
+    if (auto mod = Loader::get()->getInstalledMod(m_modID)) {
+        ModImpl::getImpl(mod)->m_settingsDirty = true;
+    }
     // this is actually p neat because now if the mod gets disabled this wont 
     // post the event so that side-effect is automatically handled :3
     if (auto mod = Loader::get()->getLoadedMod(m_modID)) {
@@ -413,6 +417,10 @@ namespace geode {
 SettingChangedEvent::SettingChangedEvent(Mod* mod, SettingValue* value)
   : mod(mod), value(value) {}
 
+std::optional<size_t> SettingChangedEvent::getFilterKey() const {
+    return hashEventKey(mod->getID());
+}
+
 // SettingChangedFilter
 
 ListenerResult SettingChangedFilter::handle(
@@ -426,6 +434,10 @@ ListenerResult SettingChangedFilter::handle(
     return ListenerResult::Propagate;
 }
 
+std::optional<size_t> SettingChangedFilter::getKey() const {
+    return hashEventKey(m_modID);
+}
+
 SettingChangedFilter::SettingChangedFilter(
     std::string const& modID,
     std::optional<std::string> const& settingKey
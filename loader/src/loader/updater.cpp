@@ -51,30 +51,20 @@ void updater::fetchLatestGithubRelease(
         return then(s_latestGithubRelease.value());
     }
 
-    auto version = VersionInfo::parse(
-        Mod::get()->getSavedValue("latest-version-auto-update-check", std::string("0.0.0"))
-    );
-
-    log::debug("Last update check result: {}", version.unwrap().toString());
-
-    std::string modifiedSince;
-    if (!force && version && version.unwrap() <= Mod::get()->getVersion() && version.unwrap() != VersionInfo(0, 0, 0)) {
-        modifiedSince = Mod::get()->getSavedValue("last-modified-auto-update-check", std::string());
-    }
-
     web::AsyncWebRequest()
         .join("loader-auto-update-check")
-        .header("If-Modified-Since", modifiedSince)
+        // if the release hasn't changed, github answers with a 304 that 
+        // doesn't count towards the rate limit
+        .cache(force ? web::CachePolicy::None : web::CachePolicy::Revalidate)
         .userAgent("github_api/1.0")
         .fetch("https://api.github.com/repos/geode-sdk/geode/releases/latest")
         .text()
-        .then([then, expect](web::SentAsyncWebRequest& req, std::string const& text) {
+        .then([then, expect](std::string const& text) {
             if (text.empty()) {
                 expect("Empty response");
                 return;
             }
             auto json = matjson::parse(text);
-            Mod::get()->setSavedValue("last-modified-auto-update-check", req.getResponseHeader("Last-Modified"));
             s_latestGithubRelease = json;
             then(json);
         })
@@ -170,12 +160,11 @@ void updater::updateSpecialFiles() {
 void updater::downloadLoaderResources(bool useLatestRelease) {
     web::AsyncWebRequest()
         .join("loader-tag-exists-check")
-        .header("If-Modified-Since", Mod::get()->getSavedValue("last-modified-tag-exists-check", std::string()))
+        .cache(web::CachePolicy::Revalidate)
         .userAgent("github_api/1.0")
         .fetch("https://api.github.com/repos/geode-sdk/geode/releases/tags/" + Loader::get()->getVersion().toString())
         .json()
-        .then([](web::SentAsyncWebRequest& req, matjson::Value const& json) {
-            Mod::get()->setSavedValue("last-modified-tag-exists-check", req.getResponseHeader("Last-Modified"));
+        .then([](matjson::Value const& json) {
             auto raw = json;
             JsonChecker checker(raw);
             auto root = checker.root("[]").obj();
@@ -285,8 +274,6 @@ void updater::downloadLoaderUpdate(std::string const& url) {
                 LoaderUpdateEvent(
                     UpdateFailed("Unable to unzip update: " + unzip.unwrapErr())
                 ).post();
-                
-                Mod::get()->setSavedValue("last-modified-auto-update-check", std::string());
                 return;
             }
             s_isNewUpdateDownloaded = true;
@@ -297,8 +284,6 @@ void updater::downloadLoaderUpdate(std::string const& url) {
             LoaderUpdateEvent(
                 UpdateFailed("Unable to download update: " + info)
             ).post();
-
-            Mod::get()->setSavedValue("last-modified-auto-update-check", std::string());
         })
         .progress([](auto&, double now, double total) {
             LoaderUpdateEvent(
@@ -310,6 +295,23 @@ void updater::downloadLoaderUpdate(std::string const& url) {
         });
 }
 
+void updater::removeLegacySavedValues() {
+    // the update checks used to keep track of their last responses in these, 
+    // which utils::web's response cache does now
+    auto mod = Mod::get();
+    for (auto key : {
+        "last-modified-auto-update-check",
+        "latest-version-auto-update-check",
+        "last-modified-tag-exists-check",
+    }) {
+        // checked first so the saved values aren't marked as changed on 
+        // every launch
+        if (std::as_const(*mod).getSaveContainer().contains(key)) {
+            mod->getSaveContainer().try_erase(key);
+        }
+    }
+}
+
 void updater::checkForLoaderUpdates() {
     // Check for updates in the background
     fetchLatestGithubRelease(
@@ -322,15 +324,9 @@ void updater::checkForLoaderUpdates() {
             root.needs("tag_name").into(ver);
 
             log::info("Latest version is {}", ver.toString());
-            Mod::get()->setSavedValue("latest-version-auto-update-check", ver.toString());
 
             // make sure release is newer
             if (ver <= Loader::get()->getVersion()) {
-                if(ver <= VersionInfo(2, 0, 0, VersionTag(VersionTag::Beta, 1))) {
-                    log::warn("Invalid loader version detected, resetting update check time");
-
-                    Mod::get()->setSavedValue("last-modified-auto-update-check", std::string());
-                }
                 return;
             }
 
@@ -357,8 +353,6 @@ void updater::checkForLoaderUpdates() {
             LoaderUpdateEvent(
                 UpdateFailed("Unable to find release asset for " GEODE_PLATFORM_NAME)
             ).post();
-            
-            Mod::get()->setSavedValue("last-modified-auto-update-check", std::string());
         },
         [](std::string const& info) {
             log::error("Failed to fetch updates {}", info);
@@ -44,5 +44,6 @@ namespace geode::updater {
 
     bool verifyLoaderResources();
     void checkForLoaderUpdates();
+    void removeLegacySavedValues();
     bool isNewUpdateDownloaded();
 }
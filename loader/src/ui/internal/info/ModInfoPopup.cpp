@@ -606,6 +606,10 @@ IndexItemInfoPopup::IndexItemInfoPopup()
 
 bool IndexItemInfoPopup::init(IndexItemHandle item, ModListLayer* list) {
     m_item = item;
+    auto loadRes = m_item->loadSpecialFiles();
+    if (!loadRes) {
+        log::warn("Unable to load details of {}: {}", m_item->getPath(), loadRes.unwrapErr());
+    }
     auto metadata = m_item->getMetadata();
     m_installListener.setFilter(metadata.getID());
 
@@ -224,6 +224,7 @@ ModCell* ModCell::create(
 ) {
     auto ret = new ModCell();
     if (ret && ret->init(mod, list, display, size)) {
+        ret->autorelease();
         return ret;
     }
     CC_SAFE_DELETE(ret);
@@ -365,6 +366,7 @@ IndexItemCell* IndexItemCell::create(
 ) {
     auto ret = new IndexItemCell();
     if (ret && ret->init(item, list, display, size)) {
+        ret->autorelease();
         return ret;
     }
     CC_SAFE_DELETE(ret);
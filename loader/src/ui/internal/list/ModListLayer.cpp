@@ -1,5 +1,6 @@
 #include "ModListLayer.hpp"
 #include "ModListCell.hpp"
+#include "ModSearchIndex.hpp"
 #include "SearchFilterPopup.hpp"
 #include <Geode/binding/ButtonSprite.hpp>
 #include <Geode/binding/CCTextInputNode.hpp>
@@ -18,9 +19,6 @@
 #include <Geode/binding/CCContentLayer.hpp>
 #include <loader/LoaderImpl.hpp>
 
-#define FTS_FUZZY_MATCH_IMPLEMENTATION
-#include <Geode/external/fts/fts_fuzzy_match.h>
-
 #ifdef GEODE_IS_WINDOWS
 #include <filesystem>
 #endif
@@ -29,204 +27,189 @@ static ModListType g_tab = ModListType::Installed;
 
 // Mods
 
-static std::optional<int> fuzzyMatch(std::string const& kw, std::string const& str) {
-    int score;
-    if (fts::fuzzy_match(kw.c_str(), str.c_str(), score)) {
-        return score;
-    }
-    return std::nullopt;
-}
-
-static std::optional<int> queryMatchKeywords(
-    ModListQuery const& query,
-    ModMetadata const& metadata
+// returns the score of an index item that matched the keywords, if it also 
+// passes the rest of the query
+static std::optional<int> queryMatch(
+    ModListQuery const& query, ModSearchIndex const& search, size_t index, int keywordScore
 ) {
-    double weighted = 0;
-
-    // fuzzy match keywords
-    if (query.keywords) {
-        bool someMatched = false;
-        auto weightedMatch = [&](std::string const& str, double weight) {
-            if (auto match = fuzzyMatch(query.keywords.value(), str)) {
-                weighted = std::max<double>(match.value() * weight, weighted);
-                someMatched = true;
-            }
-        };
-        weightedMatch(metadata.getName(), 2);
-        weightedMatch(metadata.getID(), 1);
-        weightedMatch(ranges::join(metadata.getDevelopers(), " "), 0.5);
-        weightedMatch(metadata.getDetails().value_or(""), 0.05);
-        weightedMatch(metadata.getDescription().value_or(""), 0.2);
-        if (!someMatched) {
-            return std::nullopt;
-        }
-    }
-    else {
-        if (metadata.getID() == "geode.loader") {
-            return INT_MAX;
-        }
-        // this is like the dumbest way you could possibly sort alphabetically 
-        // but it does enough to make the mods list somewhat alphabetically 
-        // sorted, at least enough so that if you're scrolling it based on 
-        // alphabetical order you will find the part you're looking for easily 
-        // so it's fine
-        return (static_cast<int>(-tolower(metadata.getName()[0])) * 256)
-            + (metadata.getName().size() > 1 ? static_cast<int>(-tolower(metadata.getName()[1])) : 0);
-    }
-
-    // if the weight is relatively small we can ignore it
-    if (weighted < 2) {
-        return std::nullopt;
-    }
-
-    // empty keywords always match
-    return static_cast<int>(weighted);
-}
-
-static std::optional<int> queryMatch(ModListQuery const& query, Mod* mod) {
-    // Only checking keywords makes sense for mods since their 
-    // platform always matches, they are always visible and they don't 
-    // currently list their tags
-    return queryMatchKeywords(query, mod->getMetadata());
-}
-
-static std::optional<int> queryMatch(ModListQuery const& query, IndexItemHandle item) {
+    auto& entry = search.at(index);
     // if no force visibility was provided and item is already installed, don't show it
-    if (!query.forceVisibility && Loader::get()->isModInstalled(item->getMetadata().getID())) {
+    if (!query.forceVisibility && Loader::get()->isModInstalled(entry.fields[ModSearchIndex::ID])) {
         return std::nullopt;
     }
     // make sure all tags match
     for (auto& tag : query.tags) {
-        if (!item->getTags().count(tag)) {
+        if (!entry.tagSet.count(tag)) {
             return std::nullopt;
         }
     }
     // make sure at least some platform matches
-    if (!ranges::contains(query.platforms, [item](PlatformID id) {
-        return item->getAvailablePlatforms().count(id);
+    if (!ranges::contains(query.platforms, [&](PlatformID id) {
+        return entry.platforms.count(id);
     })) {
         return std::nullopt;
     }
     // if no force visibility was provided and item is already installed, don't show it
-    auto canInstall = Index::get()->canInstall(item);
+    auto canInstall = Index::get()->canInstall(entry.item);
     if (!query.forceInvalid && !canInstall) {
         // log::warn(
         //     "Removing {} from the list because it cannot be installed: {}",
-        //     item->getMetadata().getID(),
+        //     entry.fields[ModSearchIndex::ID],
         //     canInstall.unwrapErr()
         // );
         return std::nullopt;
     }
-    // otherwise match keywords
-    if (auto match = queryMatchKeywords(query, item->getMetadata())) {
-        auto weighted = match.value();
-        // add extra weight on tag matches
-        if (query.keywords) {
-            if (auto match = fuzzyMatch(query.keywords.value(), ranges::join(item->getTags(), " "))) {
-                weighted += match.value() * 1.4;                    
-            }
-        }
-        // add extra weight to featured items to keep power consolidated in the 
-        // hands of the rich Geode bourgeoisie
-        // the number 420 is a reference to the number one bourgeois of modern 
-        // society, elon musk
-        weighted += item->isFeatured() ? 42069 : 0;
-        return static_cast<int>(weighted);
-    }
-    // keywords must match bruh
-    else {
-        return std::nullopt;
+    double weighted = keywordScore;
+    // add extra weight on tag matches
+    if (auto match = search.matchTags(query, index)) {
+        weighted += match.value() * 1.4;
     }
+    // add extra weight to featured items to keep power consolidated in the 
+    // hands of the rich Geode bourgeoisie
+    // the number 420 is a reference to the number one bourgeois of modern 
+    // society, elon musk
+    weighted += entry.featured ? 42069 : 0;
+    return static_cast<int>(weighted);
 }
 
-static std::optional<int> queryMatch(ModListQuery const& query, InvalidGeodeFile const& info) {
-    // if any explicit filters were provided, no match
-    if (!query.tags.empty() || query.keywords.has_value()) {
-        return std::nullopt;
+ModSearchIndex const& ModListLayer::getSearchIndex(ModListType type) {
+    auto& search = m_searchIndices[type];
+    if (!search) {
+        search = std::make_unique<ModSearchIndex>();
+        switch (type) {
+            default:
+            case ModListType::Installed: {
+                for (auto const& mod : Loader::get()->getAllMods()) {
+                    search->add(mod);
+                }
+            } break;
+
+            case ModListType::Download: {
+                for (auto const& item : Index::get()->getLatestItems()) {
+                    search->add(item);
+                }
+            } break;
+
+            case ModListType::Featured: {
+                for (auto const& item : Index::get()->getFeaturedItems()) {
+                    search->add(item);
+                }
+            } break;
+        }
     }
-    return 0;
+    return *search;
 }
 
-CCArray* ModListLayer::createModCells(ModListType type, ModListQuery const& query) {
-    auto mods = CCArray::create();
+std::vector<ModListEntry> ModListLayer::createModEntries(ModListType type, ModListQuery const& query) {
+    std::vector<ModListEntry> mods;
     switch (type) {
         default:
         case ModListType::Installed: {
             // problems first
             if (!Loader::get()->getProblems().empty()) {
-                mods->addObject(ProblemsCell::create(this, m_display, this->getCellSize()));
+                mods.push_back(ModListProblems());
             }
 
             // sort the mods by match score
-            std::multimap<int, ModListCell*> sorted;
+            std::multimap<int, ModListEntry> sorted;
 
             // then other mods
 
-            // newly installed
+            // newly installed, which are only ever a handful so they aren't 
+            // worth keeping an index of
+            ModSearchIndex installed;
             for (auto const& item : Index::get()->getItems()) {
-                if (!item->isInstalled() ||
-                    Loader::get()->isModInstalled(item->getMetadata().getID()) ||
-                    Loader::get()->isModLoaded(item->getMetadata().getID()))
+                if (!item->isInstalled())
                     continue;
-                // match the same as other installed mods
-                if (auto match = queryMatchKeywords(query, item->getMetadata())) {
-                    auto cell = IndexItemCell::create(item, this, m_display, this->getCellSize());
-                    sorted.insert({ match.value(), cell });
-                }
+                auto id = item->getID();
+                if (Loader::get()->isModInstalled(id) || Loader::get()->isModLoaded(id))
+                    continue;
+                installed.add(item);
+            }
+            // match the same as other installed mods
+            for (auto& [index, score] : installed.match(query)) {
+                sorted.insert({ score, installed.at(index).item });
             }
 
             // loaded
-            for (auto const& mod : Loader::get()->getAllMods()) {
-                if (auto match = queryMatch(query, mod)) {
-                    auto cell = ModCell::create(mod, this, m_display, this->getCellSize());
-                    sorted.insert({ match.value(), cell });
-                }
+            // Only checking keywords makes sense for mods since their 
+            // platform always matches, they are always visible and they don't 
+            // currently list their tags
+            auto& loaded = this->getSearchIndex(ModListType::Installed);
+            for (auto& [index, score] : loaded.match(query)) {
+                sorted.insert({ score, loaded.at(index).mod });
             }
 
             // add the mods sorted
-            for (auto& [score, cell] : ranges::reverse(sorted)) {
-                mods->addObject(cell);
+            for (auto& [score, entry] : ranges::reverse(sorted)) {
+                mods.push_back(entry);
             }
         } break;
 
-        case ModListType::Download: {
+        case ModListType::Download:
+        case ModListType::Featured: {
             // sort the mods by match score 
             std::multimap<int, IndexItemHandle> sorted;
 
-            auto index = Index::get();
-            for (auto const& item : index->getLatestItems()) {
-                if (auto match = queryMatch(query, item)) {
-                    sorted.insert({ match.value(), item });
+            // only the items that matched the keywords are checked against 
+            // the rest of the query, since that's the cheaper check
+            auto& search = this->getSearchIndex(type);
+            for (auto& [index, score] : search.match(query)) {
+                if (auto match = queryMatch(query, search, index, score)) {
+                    sorted.insert({ match.value(), search.at(index).item });
                 }
             }
 
             // add the mods sorted
             for (auto& [score, item] : ranges::reverse(sorted)) {
-                mods->addObject(IndexItemCell::create(
-                    item, this, m_display, this->getCellSize()
-                ));
+                mods.push_back(item);
             }
         } break;
+    }
+    return mods;
+}
 
-        case ModListType::Featured: {
-            // sort the mods by match score 
-            std::multimap<int, IndexItemHandle> sorted;
+size_t ModListLayer::getCellCount() {
+    return m_entries.size();
+}
 
-            for (auto const& item : Index::get()->getFeaturedItems()) {
-                if (auto match = queryMatch(query, item)) {
-                    sorted.insert({ match.value(), item });
-                }
-            }
+float ModListLayer::getCellHeight() {
+    return this->getCellSize().height;
+}
 
-            // add the mods sorted
-            for (auto& [score, item] : ranges::reverse(sorted)) {
-                mods->addObject(IndexItemCell::create(
-                    item, this, m_display, this->getCellSize()
-                ));
+CCNode* ModListLayer::bindCell(CCNode* reuse, size_t index) {
+    // cells lay themselves out when they're created, so they can only be 
+    // reused for the entry they were created for
+    if (reuse && reuse->getTag() == static_cast<int>(index)) {
+        auto cell = static_cast<ModListCell*>(reuse);
+        cell->updateState();
+        return cell;
+    }
+    ModListCell* cell = std::visit(makeVisitor {
+        [&](ModListProblems const&) -> ModListCell* {
+            return ProblemsCell::create(this, m_display, this->getCellSize());
+        },
+        [&](Mod* mod) -> ModListCell* {
+            return ModCell::create(mod, this, m_display, this->getCellSize());
+        },
+        [&](IndexItemHandle const& item) -> ModListCell* {
+            return IndexItemCell::create(item, this, m_display, this->getCellSize());
+        },
+    }, m_entries.at(index));
+    if (cell) {
+        cell->setTag(static_cast<int>(index));
+        // the cell's menus need to go above the list like the rest did. 
+        // only the new cell needs it, and its menus only register for 
+        // touches once it enters the scene
+        Loader::get()->queueInMainThread([layer = Ref(this), cell = Ref<CCNode>(cell)]() {
+            auto priority = 0;
+            if (auto handler = CCTouchDispatcher::get()->findHandler(layer.data())) {
+                priority = handler->m_nPriority - 1;
             }
-        } break;
+            cocos::handleTouchPriorityWith(cell, priority, true);
+        });
     }
-    return mods;
+    return cell;
 }
 
 // UI
@@ -471,17 +454,17 @@ void ModListLayer::reloadList(bool keepScroll, std::optional<ModListQuery> const
     // remove old list
     if (m_list) m_list->removeFromParent();
 
-    auto items = this->createModCells(g_tab, m_query);
+    // cells are only created by the list once they're in view
+    m_entries = this->createModEntries(g_tab, m_query);
 
     // create new list
-    auto list = ListView::create(
-        items,
-        this->getCellSize().height,
+    auto list = RecyclingListView::create(
+        this,
         this->getListSize().width,
         this->getListSize().height
     );
     // please forgive me for this code
-    auto problemsCell = typeinfo_cast<ProblemsCell*>(list->m_entries->objectAtIndex(0));
+    auto problemsCell = typeinfo_cast<ProblemsCell*>(list->getBoundCell(0));
     if (problemsCell) {
         auto cellView =
             typeinfo_cast<TableViewCell*>(list->m_tableView->m_cellArray->objectAtIndex(0));
@@ -491,7 +474,7 @@ void ModListLayer::reloadList(bool keepScroll, std::optional<ModListQuery> const
     }
 
     // set list status
-    if (!items->count()) {
+    if (m_entries.empty()) {
         m_listLabel->setVisible(true);
         if (!Index::get()->isUpdating()) {
             m_listLabel->setString("No mods found");
@@ -589,10 +572,12 @@ void ModListLayer::reloadList(bool keepScroll, std::optional<ModListQuery> const
 }
 
 void ModListLayer::updateAllStates() {
-    for (auto cell : CCArrayExt<GenericListCell*>(
-        m_list->m_listView->m_tableView->m_cellArray
-    )) {
-        static_cast<ModListCell*>(cell->getChildByID("mod-list-cell"))->updateState();
+    // cells that aren't in view are updated once they're bound again
+    auto list = static_cast<RecyclingListView*>(m_list->m_listView);
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        if (auto cell = static_cast<ModListCell*>(list->getBoundCell(i))) {
+            cell->updateState();
+        }
     }
 }
 
@@ -634,9 +619,11 @@ void ModListLayer::onIndexUpdate(IndexUpdateEvent* event) {
             m_listLabel->setString((msg + "...").c_str());
         },
         [&](UpdateFinished const&) {
+            this->clearSearchIndices();
             this->reloadList();
         },
         [&](UpdateFailed const& error) {
+            this->clearSearchIndices();
             this->reloadList();
         }
     }, event->status);
@@ -656,9 +643,14 @@ void ModListLayer::keyBackClicked() {
 }
 
 void ModListLayer::onReload(CCObject*) {
+    this->clearSearchIndices();
     this->reloadList();
 }
 
+void ModListLayer::clearSearchIndices() {
+    m_searchIndices.clear();
+}
+
 void ModListLayer::onExpand(CCObject* sender) {
     m_display = static_cast<CCMenuItemToggler*>(sender)->isToggled() ?
         ModListDisplay::Concise :
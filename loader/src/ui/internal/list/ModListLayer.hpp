@@ -2,11 +2,14 @@
 
 #include <Geode/binding/TextInputDelegate.hpp>
 #include <Geode/loader/Index.hpp>
+#include <Geode/ui/ListView.hpp>
+#include <variant>
 
 using namespace geode::prelude;
 
 class SearchFilterPopup;
 class ModListCell;
+class ModSearchIndex;
 
 enum class ModListType {
     Installed,
@@ -41,7 +44,16 @@ struct ModListQuery {
     std::unordered_set<std::string> tags;
 };
 
-class ModListLayer : public CCLayer, public TextInputDelegate {
+// the problems cell at the top of the installed list
+struct ModListProblems {};
+
+/**
+ * Something shown on the mod list. Its cell is only created once it scrolls 
+ * into view
+ */
+using ModListEntry = std::variant<ModListProblems, Mod*, IndexItemHandle>;
+
+class ModListLayer : public CCLayer, public TextInputDelegate, public ListViewDataSource {
 protected:
     GJListLayer* m_list = nullptr;
     CCClippingNode* m_tabsGradientNode = nullptr;
@@ -64,6 +76,10 @@ protected:
     ModListQuery m_query;
     ModListDisplay m_display = ModListDisplay::Concise;
     EventListener<IndexUpdateFilter> m_indexListener;
+    // built when a tab is first searched, and thrown away when the mods or 
+    // the index change
+    std::unordered_map<ModListType, std::unique_ptr<ModSearchIndex>> m_searchIndices;
+    std::vector<ModListEntry> m_entries;
 
     virtual ~ModListLayer();
 
@@ -84,10 +100,16 @@ protected:
     // most requested feature of all time
     void keyBackClicked() override;
 
-    CCArray* createModCells(ModListType type, ModListQuery const& query);
+    std::vector<ModListEntry> createModEntries(ModListType type, ModListQuery const& query);
+    ModSearchIndex const& getSearchIndex(ModListType type);
+    void clearSearchIndices();
     CCSize getCellSize() const;
     CCSize getListSize() const;
 
+    size_t getCellCount() override;
+    float getCellHeight() override;
+    CCNode* bindCell(CCNode* reuse, size_t index) override;
+
 public:
     static ModListLayer* create();
     static ModListLayer* scene();
@@ -0,0 +1,255 @@
+#include "ModSearchIndex.hpp"
+#include "ModListLayer.hpp"
+#include <Geode/utils/ranges.hpp>
+#include <algorithm>
+#include <cctype>
+#include <climits>
+
+#define FTS_FUZZY_MATCH_IMPLEMENTATION
+#include <Geode/external/fts/fts_fuzzy_match.h>
+
+// how much a match in each field is worth
+static constexpr std::array<double, ModSearchIndex::FieldCount> FIELD_WEIGHTS = {
+    2,    // name
+    1,    // id
+    0.5,  // developers
+    0.2,  // description
+    0.05, // details
+};
+// entries whose best weighted match is below this don't match at all
+static constexpr double MIN_WEIGHTED_SCORE = 2;
+
+static bool isLongField(size_t field) {
+    return field == ModSearchIndex::Description || field == ModSearchIndex::Details;
+}
+
+static std::optional<int> fuzzyMatch(std::string const& kw, std::string const& str) {
+    int score;
+    if (fts::fuzzy_match(kw.c_str(), str.c_str(), score)) {
+        return score;
+    }
+    return std::nullopt;
+}
+
+// the best score fts::fuzzy_match can give a string of this length: every 
+// matched letter gets the sequential and separator bonuses and every other 
+// letter costs a point
+static int64_t getMaxScore(size_t length, size_t patternLength) {
+    auto unmatched = static_cast<int64_t>(length) - static_cast<int64_t>(patternLength);
+    return 100 + 15 + 45 * static_cast<int64_t>(patternLength) - std::max<int64_t>(unmatched, 0);
+}
+
+// fuzzy matching is case insensitive, so the letters and digits get a bit 
+// each and everything else shares the rest
+static uint64_t getCharMask(std::string_view str) {
+    uint64_t mask = 0;
+    for (unsigned char c : str) {
+        c = static_cast<unsigned char>(std::tolower(c));
+        if (c >= 'a' && c <= 'z') {
+            mask |= 1ull << (c - 'a');
+        }
+        else if (c >= '0' && c <= '9') {
+            mask |= 1ull << (26 + c - '0');
+        }
+        else {
+            mask |= 1ull << (36 + c % 28);
+        }
+    }
+    return mask;
+}
+
+// lowercase, with every run of punctuation and whitespace turned into a 
+// single space
+static std::string normalize(std::string_view str) {
+    std::string res;
+    res.reserve(str.size());
+    for (unsigned char c : str) {
+        if (std::isalnum(c) || c >= 0x80) {
+            res.push_back(static_cast<char>(std::tolower(c)));
+        }
+        else if (!res.empty() && res.back() != ' ') {
+            res.push_back(' ');
+        }
+    }
+    if (!res.empty() && res.back() == ' ') {
+        res.pop_back();
+    }
+    return res;
+}
+
+static void getTrigrams(std::string_view normalized, std::vector<uint32_t>& out) {
+    for (size_t i = 0; i + 3 <= normalized.size(); i++) {
+        out.push_back(
+            static_cast<uint32_t>(static_cast<uint8_t>(normalized[i])) << 16 |
+            static_cast<uint32_t>(static_cast<uint8_t>(normalized[i + 1])) << 8 |
+            static_cast<uint32_t>(static_cast<uint8_t>(normalized[i + 2]))
+        );
+    }
+}
+
+void ModSearchIndex::add(Entry entry) {
+    auto index = static_cast<uint32_t>(m_entries.size());
+
+    std::array<uint64_t, FieldCount> masks;
+    std::vector<uint32_t> trigrams;
+    for (size_t field = 0; field < FieldCount; field++) {
+        masks[field] = getCharMask(entry.fields[field]);
+        if (isLongField(field)) {
+            getTrigrams(normalize(entry.fields[field]), trigrams);
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    for (auto trigram : trigrams) {
+        m_postings[trigram].push_back(index);
+    }
+
+    m_charMasks.push_back(masks);
+    m_entries.push_back(std::move(entry));
+}
+
+void ModSearchIndex::add(Mod* mod) {
+    auto metadata = mod->getMetadata();
+    Entry entry;
+    entry.mod = mod;
+    entry.fields[Name] = metadata.getName();
+    entry.fields[ID] = metadata.getID();
+    entry.developers = metadata.getDevelopers();
+    entry.fields[Developers] = ranges::join(entry.developers, " ");
+    entry.fields[Description] = metadata.getDescription().value_or("");
+    entry.fields[Details] = metadata.getDetails().value_or("");
+    this->add(std::move(entry));
+}
+
+void ModSearchIndex::add(IndexItemHandle item) {
+    // the item's metadata isn't used since parsing the mod.json of every 
+    // item would take a while, and it only has the details once 
+    // loadSpecialFiles is called
+    Entry entry;
+    entry.item = item;
+    entry.fields[Name] = item->getName();
+    entry.fields[ID] = item->getID();
+    entry.developers = item->getDevelopers();
+    entry.fields[Developers] = ranges::join(entry.developers, " ");
+    entry.fields[Description] = item->getDescription().value_or("");
+    entry.fields[Details] = item->getDetails().value_or("");
+    entry.tagSet = item->getTags();
+    entry.tags = ranges::join(entry.tagSet, " ");
+    entry.platforms = item->getAvailablePlatforms();
+    entry.featured = item->isFeatured();
+    this->add(std::move(entry));
+}
+
+size_t ModSearchIndex::size() const {
+    return m_entries.size();
+}
+
+ModSearchIndex::Entry const& ModSearchIndex::at(size_t index) const {
+    return m_entries.at(index);
+}
+
+std::vector<std::pair<size_t, int>> ModSearchIndex::match(ModListQuery const& query) const {
+    std::vector<std::pair<size_t, int>> res;
+
+    if (!query.keywords) {
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            auto& entry = m_entries[i];
+            if (entry.fields[ID] == "geode.loader") {
+                res.push_back({ i, INT_MAX });
+                continue;
+            }
+            // this is like the dumbest way you could possibly sort alphabetically 
+            // but it does enough to make the mods list somewhat alphabetically 
+            // sorted, at least enough so that if you're scrolling it based on 
+            // alphabetical order you will find the part you're looking for easily 
+            // so it's fine
+            auto& name = entry.fields[Name];
+            res.push_back({ i,
+                (name.size() > 0 ? static_cast<int>(-tolower(name[0])) * 256 : 0) +
+                (name.size() > 1 ? static_cast<int>(-tolower(name[1])) : 0)
+            });
+        }
+        return res;
+    }
+
+    auto const& kw = query.keywords.value();
+    auto kwMask = getCharMask(kw);
+
+    // long fields are only matched if they contain every trigram of the 
+    // keywords. shorter keywords have none, so they fall back to the 
+    // character check like the short fields
+    std::optional<std::vector<uint32_t>> longCandidates;
+    std::vector<uint32_t> trigrams;
+    getTrigrams(normalize(kw), trigrams);
+    if (!trigrams.empty()) {
+        std::vector<std::vector<uint32_t> const*> postings;
+        for (auto trigram : trigrams) {
+            auto it = m_postings.find(trigram);
+            if (it == m_postings.end()) {
+                postings.clear();
+                break;
+            }
+            postings.push_back(&it->second);
+        }
+        longCandidates.emplace();
+        if (!postings.empty()) {
+            // start with the rarest trigram so the intersection stays small
+            std::sort(postings.begin(), postings.end(), [](auto a, auto b) {
+                return a->size() < b->size();
+            });
+            *longCandidates = *postings.front();
+            for (size_t i = 1; i < postings.size() && !longCandidates->empty(); i++) {
+                std::vector<uint32_t> intersection;
+                std::set_intersection(
+                    longCandidates->begin(), longCandidates->end(),
+                    postings[i]->begin(), postings[i]->end(),
+                    std::back_inserter(intersection)
+                );
+                *longCandidates = std::move(intersection);
+            }
+        }
+    }
+
+    auto nextCandidate = longCandidates ? longCandidates->begin() : std::vector<uint32_t>::const_iterator();
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        bool longAllowed = true;
+        if (longCandidates) {
+            while (nextCandidate != longCandidates->end() && *nextCandidate < i) {
+                ++nextCandidate;
+            }
+            longAllowed = nextCandidate != longCandidates->end() && *nextCandidate == i;
+        }
+
+        double weighted = 0;
+        for (size_t field = 0; field < FieldCount; field++) {
+            if (isLongField(field) && !longAllowed) {
+                continue;
+            }
+            // every character of the keywords has to appear for a match
+            if ((m_charMasks[i][field] & kwMask) != kwMask) {
+                continue;
+            }
+            auto& str = m_entries[i].fields[field];
+            // skip fields that couldn't score enough to count anyway
+            if (getMaxScore(str.size(), kw.size()) * FIELD_WEIGHTS[field] < MIN_WEIGHTED_SCORE) {
+                continue;
+            }
+            if (auto match = fuzzyMatch(kw, str)) {
+                weighted = std::max<double>(match.value() * FIELD_WEIGHTS[field], weighted);
+            }
+        }
+
+        // if the weight is relatively small we can ignore it
+        if (weighted >= MIN_WEIGHTED_SCORE) {
+            res.push_back({ i, static_cast<int>(weighted) });
+        }
+    }
+    return res;
+}
+
+std::optional<int> ModSearchIndex::matchTags(ModListQuery const& query, size_t index) const {
+    if (!query.keywords) {
+        return std::nullopt;
+    }
+    return fuzzyMatch(query.keywords.value(), m_entries.at(index).tags);
+}
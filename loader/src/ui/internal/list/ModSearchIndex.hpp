@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Geode/loader/Index.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <array>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace geode::prelude;
+
+struct ModListQuery;
+
+/**
+ * The fields the mod list searches through, copied out of the metadata of
+ * every mod once so typing in the search box doesn't have to. Candidates
+ * for a query are found before anything is fuzzy matched: short fields are
+ * skipped unless they contain every character of the query, and long ones
+ * unless they contain every trigram of it, looked up in postings built from
+ * their lowercased text
+ */
+class ModSearchIndex final {
+public:
+    enum Field {
+        Name,
+        ID,
+        Developers,
+        Description,
+        Details,
+        FieldCount,
+    };
+
+    struct Entry {
+        Mod* mod = nullptr;
+        IndexItemHandle item;
+        std::array<std::string, FieldCount> fields;
+        std::vector<std::string> developers;
+        // joined tags, for scoring
+        std::string tags;
+        std::unordered_set<std::string> tagSet;
+        std::unordered_set<PlatformID> platforms;
+        bool featured = false;
+    };
+
+protected:
+    std::vector<Entry> m_entries;
+    // characters present in each field, see getCharMask
+    std::vector<std::array<uint64_t, FieldCount>> m_charMasks;
+    // sorted indices of the entries whose long fields contain a trigram
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_postings;
+
+    void add(Entry entry);
+
+public:
+    void add(Mod* mod);
+    void add(IndexItemHandle item);
+
+    size_t size() const;
+    Entry const& at(size_t index) const;
+
+    /**
+     * Score the entries by how well they match the keywords of a query.
+     * Without keywords every entry matches, scored to sort them roughly
+     * alphabetically
+     * @returns Indices of the matching entries and their scores
+     */
+    std::vector<std::pair<size_t, int>> match(ModListQuery const& query) const;
+
+    /**
+     * Fuzzy match the keywords of a query against the entry's tags
+     */
+    std::optional<int> matchTags(ModListQuery const& query, size_t index) const;
+};
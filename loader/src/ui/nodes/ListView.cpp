@@ -3,6 +3,7 @@
 #include <Geode/ui/ListView.hpp>
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/cocos.hpp>
+#include <algorithm>
 
 using namespace geode::prelude;
 
@@ -78,3 +79,113 @@ ListView* ListView::create(CCArray* items, float itemHeight, float width, float
     CC_SAFE_DELETE(ret);
     return nullptr;
 }
+
+void RecyclingListView::setupList(float delta) {
+    m_rows.assign(m_entries->count(), nullptr);
+    m_bound.assign(m_entries->count(), nullptr);
+    ListView::setupList(delta);
+}
+
+void RecyclingListView::loadCell(TableViewCell* cell, int index) {
+    // rows only get a node once they scroll into view
+    auto lcell = as<GenericListCell*>(cell);
+    m_rows.at(index) = lcell;
+    lcell->updateBGColor(index);
+}
+
+RecyclingListView* RecyclingListView::create(ListViewDataSource* dataSource, float width, float height) {
+    // the table still wants an entry for every row, but the rows stay empty 
+    // until they're in view so they can all share one
+    auto placeholder = CCNode::create();
+    auto count = dataSource->getCellCount();
+    auto items = CCArray::createWithCapacity(count);
+    for (size_t i = 0; i < count; i++) {
+        items->addObject(placeholder);
+    }
+
+    auto ret = new RecyclingListView();
+    if (ret) {
+        ret->m_dataSource = dataSource;
+        ret->m_itemSeparation = dataSource->getCellHeight();
+        if (ret->init(items, BoomListType::Default, width, height)) {
+            ret->autorelease();
+            ret->updateVisibleCells();
+            ret->schedule(schedule_selector(RecyclingListView::checkVisibleCells));
+            return ret;
+        }
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool RecyclingListView::isRowVisible(size_t index) const {
+    auto row = m_rows.at(index);
+    if (!row) return false;
+    auto y = row->getPositionY() + m_tableView->m_contentLayer->getPositionY();
+    return y + m_itemSeparation > 0.f && y < m_tableView->getContentSize().height;
+}
+
+void RecyclingListView::bindCell(size_t index) {
+    // prefer the node that last showed this cell, since the data source can 
+    // hand it back as is
+    auto it = std::find_if(m_pool.begin(), m_pool.end(), [&](auto const& pooled) {
+        return pooled.first == index;
+    });
+    if (it == m_pool.end() && !m_pool.empty()) {
+        it = m_pool.begin();
+    }
+    Ref<CCNode> reuse;
+    if (it != m_pool.end()) {
+        reuse = it->second;
+        m_pool.erase(it);
+    }
+
+    auto node = m_dataSource->bindCell(reuse, index);
+    if (!node) return;
+
+    auto row = m_rows.at(index);
+    node->setContentSize(row->getScaledContentSize());
+    node->setPosition(0, 0);
+    row->addChild(node);
+    m_bound.at(index) = node;
+}
+
+void RecyclingListView::unbindCell(size_t index) {
+    auto node = m_bound.at(index);
+    m_bound.at(index) = nullptr;
+    m_pool.push_back({ index, node });
+    node->removeFromParent();
+
+    // keep about a screen's worth of nodes around for scrolling back
+    auto maxPooled = static_cast<size_t>(m_tableView->getContentSize().height / m_itemSeparation) + 2;
+    while (m_pool.size() > maxPooled) {
+        m_pool.pop_front();
+    }
+}
+
+void RecyclingListView::updateVisibleCells() {
+    m_lastScroll = m_tableView->m_contentLayer->getPositionY();
+
+    // unbind first so the nodes can be reused right away
+    for (size_t i = 0; i < m_rows.size(); i++) {
+        if (m_bound[i] && !this->isRowVisible(i)) {
+            this->unbindCell(i);
+        }
+    }
+    for (size_t i = 0; i < m_rows.size(); i++) {
+        if (!m_bound[i] && this->isRowVisible(i)) {
+            this->bindCell(i);
+        }
+    }
+}
+
+void RecyclingListView::checkVisibleCells(float) {
+    if (m_tableView->m_contentLayer->getPositionY() != m_lastScroll) {
+        this->updateVisibleCells();
+    }
+}
+
+CCNode* RecyclingListView::getBoundCell(size_t index) const {
+    if (index >= m_bound.size()) return nullptr;
+    return m_bound[index];
+}
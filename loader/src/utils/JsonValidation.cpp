@@ -297,8 +297,8 @@ JsonMaybeValue JsonMaybeObject::needs(std::string const& key) {
 
 
 // TODO: gross hack :3 (ctrl+f this comment to find the other part)
-extern bool s_jsonCheckerShouldCheckUnknownKeys;
-bool s_jsonCheckerShouldCheckUnknownKeys = true;
+extern thread_local bool s_jsonCheckerShouldCheckUnknownKeys;
+thread_local bool s_jsonCheckerShouldCheckUnknownKeys = true;
 void JsonMaybeObject::checkUnknownKeys() {
     if (!s_jsonCheckerShouldCheckUnknownKeys)
         return;
@@ -3,7 +3,11 @@
 #include <Geode/utils/map.hpp>
 #include <Geode/utils/string.hpp>
 #include <matjson.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <mz.h>
 #include <mz_os.h>
 #include <mz_strm.h>
@@ -11,11 +15,18 @@
 #include <mz_strm_mem.h>
 #include <mz_zip.h>
 #include <internal/FileWatcher.hpp>
+#include <internal/ThreadPool.hpp>
 #include <Geode/utils/ranges.hpp>
 #include <Geode/loader/Loader.hpp>
 
 #ifdef GEODE_IS_WINDOWS
 #include <filesystem>
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 using namespace geode::prelude;
@@ -102,6 +113,76 @@ Result<> utils::file::writeBinary(ghc::filesystem::path const& path, ByteVector
     return Ok();
 }
 
+Result<> utils::file::writeStringSafe(ghc::filesystem::path const& path, std::string const& data) {
+    // named after the thread so two threads writing the same file at once 
+    // can't end up writing into each other's temporary file
+    auto tempPath = path;
+    tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+#ifdef GEODE_IS_WINDOWS
+    auto handle = CreateFileW(
+        tempPath.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        return Err("Unable to open file");
+    }
+    DWORD written = 0;
+    bool ok = WriteFile(handle, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) &&
+        written == data.size();
+    ok = FlushFileBuffers(handle) && ok;
+    CloseHandle(handle);
+    if (!ok) {
+        DeleteFileW(tempPath.wstring().c_str());
+        return Err("Unable to write file");
+    }
+    if (!MoveFileExW(
+        tempPath.wstring().c_str(), path.wstring().c_str(),
+        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+    )) {
+        DeleteFileW(tempPath.wstring().c_str());
+        return Err("Unable to replace file");
+    }
+#else
+    auto fd = ::open(tempPath.string().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return Err("Unable to open file");
+    }
+    bool ok = true;
+    size_t offset = 0;
+    while (offset < data.size()) {
+        auto count = ::write(fd, data.data() + offset, data.size() - offset);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        offset += count;
+    }
+    ok = ::fsync(fd) == 0 && ok;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        ::unlink(tempPath.string().c_str());
+        return Err("Unable to write file");
+    }
+    if (std::rename(tempPath.string().c_str(), path.string().c_str()) != 0) {
+        ::unlink(tempPath.string().c_str());
+        return Err("Unable to replace file");
+    }
+    // the rename only survives a crash once the directory entry is synced
+    auto parent = path.parent_path();
+    auto dir = ::open(parent.empty() ? "." : parent.string().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0) {
+        return Err("Unable to open parent directory");
+    }
+    ok = ::fsync(dir) == 0;
+    ::close(dir);
+    if (!ok) {
+        return Err("Unable to sync parent directory");
+    }
+#endif
+    return Ok();
+}
+
 Result<> utils::file::createDirectory(ghc::filesystem::path const& path) {
     std::error_code ec;
 #ifdef GEODE_IS_WINDOWS
@@ -153,13 +234,85 @@ Result<std::vector<ghc::filesystem::path>> utils::file::readDirectory(
 // Unzip
 
 static constexpr auto MAX_ENTRY_PATH_LEN = 256;
+// Name of the file Unzip::extractChangedTo keeps track of extracted entries in
+static constexpr auto EXTRACT_MANIFEST_NAME = ".extract-manifest.json";
+// Below this many entries, spreading extraction over threads costs more than 
+// it saves
+static constexpr size_t PARALLEL_EXTRACT_MIN_ENTRIES = 16;
+static constexpr size_t PARALLEL_EXTRACT_ENTRIES_PER_THREAD = 8;
 
 struct ZipEntry {
     bool isDirectory;
     int64_t compressedSize;
     int64_t uncompressedSize;
+    uint32_t crc32;
 };
 
+// make sure zip files like root/../../file.txt don't get extracted to avoid 
+// zip attacks. This is purely lexical since the entry doesn't exist on disk yet
+static bool isWithinDir(ghc::filesystem::path const& dir, ghc::filesystem::path const& entry) {
+    auto rel = (dir / entry).lexically_normal().lexically_relative(dir.lexically_normal());
+    return !rel.empty() && *rel.begin() != "..";
+}
+
+static Result<> writeEntryData(ghc::filesystem::path const& path, uint8_t const* data, size_t size) {
+    std::ofstream file;
+#if _WIN32
+    file.open(path.wstring(), std::ios::out | std::ios::binary);
+#else
+    file.open(path.string(), std::ios::out | std::ios::binary);
+#endif
+    if (!file.is_open()) {
+        return Err("Unable to open file");
+    }
+    file.write(reinterpret_cast<char const*>(data), size);
+    if (!file) {
+        return Err("Unable to write file");
+    }
+    return Ok();
+}
+
+static std::string getEntryStamp(ZipEntry const& entry) {
+    return fmt::format("{:08x}:{}", entry.crc32, entry.uncompressedSize);
+}
+
+static matjson::Value readExtractManifest(ghc::filesystem::path const& dir) {
+    auto manifestPath = dir / EXTRACT_MANIFEST_NAME;
+    if (ghc::filesystem::exists(manifestPath)) {
+        auto res = file::readJson(manifestPath);
+        if (res && res.unwrap().is_object()) {
+            return res.unwrap();
+        }
+    }
+    return matjson::Object();
+}
+
+// Path of a zip entry relative to the directory in the zip being extracted, 
+// or nothing if it's outside of it or is the directory itself
+static std::optional<ghc::filesystem::path> getPathInRoot(
+    ghc::filesystem::path const& name, ghc::filesystem::path const& root
+) {
+    if (root.empty()) {
+        return name;
+    }
+    auto rel = name.lexically_relative(root);
+    if (rel.empty() || rel == "." || *rel.begin() == "..") {
+        return std::nullopt;
+    }
+    return rel;
+}
+
+// Hard link an unchanged file from the previous extraction, falling back to 
+// copying it if the file system doesn't support links
+static bool reuseFile(ghc::filesystem::path const& from, ghc::filesystem::path const& to) {
+    std::error_code ec;
+    ghc::filesystem::create_hard_link(from, to, ec);
+    if (!ec) {
+        return true;
+    }
+    return ghc::filesystem::copy_file(from, to, ghc::filesystem::copy_options::overwrite_existing, ec) && !ec;
+}
+
 class Zip::Impl final {
 public:
     using Path = Zip::Path;
@@ -170,6 +323,8 @@ private:
     int32_t m_mode;
     std::variant<Path, ByteVector> m_srcDest;
     std::unordered_map<Path, ZipEntry> m_entries;
+    // entry names in central directory order
+    std::vector<Path> m_entryOrder;
     utils::MiniFunction<void(uint32_t, uint32_t)> m_progressCallback;
 
     Result<> init() {
@@ -241,7 +396,9 @@ private:
                 .isDirectory = mz_zip_entry_is_dir(m_handle) == MZ_OK,
                 .compressedSize = info->compressed_size,
                 .uncompressedSize = info->uncompressed_size,
+                .crc32 = info->crc,
             } });
+            m_entryOrder.push_back(filePath);
 
             err = mz_zip_goto_next_entry(m_handle);
         }
@@ -286,85 +443,252 @@ public:
         m_progressCallback = callback;
     }
 
-    Result<> extractAt(Path const& dir, Path const& name) {
-        auto entry = m_entries.at(name);
+    // Extract the entry the handle is currently pointing at. The buffer is 
+    // reused between entries to avoid an allocation per file
+    Result<> extractCurrentTo(
+        Path const& target, Path const& name, ByteVector& buffer,
+        std::unordered_set<Path>& createdDirs
+    ) {
+        auto const& entry = m_entries.at(name);
+
+        if (entry.isDirectory) {
+            if (createdDirs.insert(target).second) {
+                GEODE_UNWRAP(file::createDirectoryAll(target));
+            }
+            return Ok();
+        }
+
+        if (createdDirs.insert(target.parent_path()).second) {
+            GEODE_UNWRAP(file::createDirectoryAll(target.parent_path()));
+        }
 
         GEODE_UNWRAP(
             mzTry(mz_zip_entry_read_open(m_handle, 0, nullptr))
             .expect("Unable to open entry (code {error})")
         );
 
-        // if the file is empty, its data is empty (duh)
-        if (!entry.uncompressedSize) {
-            return Ok();
+        auto size = static_cast<size_t>(entry.uncompressedSize);
+        if (buffer.size() < size) {
+            buffer.resize(size);
         }
+        size_t total = 0;
+        while (total < size) {
+            auto read = mz_zip_entry_read(m_handle, buffer.data() + total, static_cast<int32_t>(size - total));
+            if (read <= 0) {
+                mz_zip_entry_close(m_handle);
+                return Err("Unable to read entry (code " + std::to_string(read) + ")");
+            }
+            total += read;
+        }
+        mz_zip_entry_close(m_handle);
 
-        ByteVector res;
-        res.resize(entry.uncompressedSize);
-        auto read = mz_zip_entry_read(m_handle, res.data(), entry.uncompressedSize);
-        if (read < 0) {
-            mz_zip_entry_close(m_handle);
-            return Err("Unable to read entry (code " + std::to_string(read) + ")");
+        GEODE_UNWRAP(writeEntryData(target, buffer.data(), size).expect("Unable to write to {}: {error}", target));
+
+        return Ok();
+    }
+
+    // Extract the entries whose position in the central directory is marked 
+    // in `selected`. If the zip is backed by a file, the work is split between 
+    // multiple threads that each open their own handle to it. Entries are 
+    // extracted relative to `root`, which has to contain all selected entries
+    Result<> extractEntries(Path const& dir, std::vector<bool> const& selected, Path const& root = Path()) {
+        auto total = static_cast<uint32_t>(std::count(selected.begin(), selected.end(), true));
+        if (total == 0) {
+            return Ok();
         }
 
-        mz_zip_entry_close(m_handle);
+        std::atomic_uint32_t extracted = 0;
+        std::mutex progressMutex;
+
+        auto extractShare = [&](Impl& zip, size_t worker, size_t workerCount) -> Result<> {
+            ByteVector buffer;
+            std::unordered_set<Path> createdDirs;
+            GEODE_UNWRAP(
+                mzTry(mz_zip_goto_first_entry(zip.m_handle))
+                .expect("Unable to navigate to first entry (code {error})")
+            );
+            size_t position = 0;
+            size_t nth = 0;
+            do {
+                if (position >= selected.size()) {
+                    break;
+                }
+                if (selected[position] && nth++ % workerCount == worker) {
+                    auto const& name = zip.m_entryOrder[position];
+                    auto rel = getPathInRoot(name, root).value_or(name);
+                    if (isWithinDir(dir, rel)) {
+                        GEODE_UNWRAP(zip.extractCurrentTo(dir / rel, name, buffer, createdDirs));
+                    }
+                    else {
+                        log::error("Zip entry '{}' is not contained within zip bounds", dir / rel);
+                    }
+                    auto current = ++extracted;
+                    std::lock_guard lock(progressMutex);
+                    m_progressCallback(current, total);
+                }
+                position += 1;
+            } while (mz_zip_goto_next_entry(zip.m_handle) == MZ_OK);
+            return Ok();
+        };
 
-        GEODE_UNWRAP(file::createDirectoryAll((dir / name).parent_path()));
-        GEODE_UNWRAP(file::writeBinary(dir / name, res).expect("Unable to write to {}: {error}", dir / name));
+        if (!std::holds_alternative<Path>(m_srcDest) || total < PARALLEL_EXTRACT_MIN_ENTRIES) {
+            return extractShare(*this, 0, 1);
+        }
 
+        auto workerCount = std::min<size_t>(
+            ThreadPool::get()->getThreadCount() + 1,
+            (total + PARALLEL_EXTRACT_ENTRIES_PER_THREAD - 1) / PARALLEL_EXTRACT_ENTRIES_PER_THREAD
+        );
+        std::vector<Result<>> results(workerCount, Ok());
+        ThreadPool::get()->parallelFor(workerCount, [&](size_t worker) {
+            if (worker == 0) {
+                results[worker] = extractShare(*this, worker, workerCount);
+                return;
+            }
+            auto zip = Impl::inFile(std::get<Path>(m_srcDest), MZ_OPEN_MODE_READ);
+            if (!zip) {
+                results[worker] = Err(zip.unwrapErr());
+                return;
+            }
+            results[worker] = extractShare(*zip.unwrap(), worker, workerCount);
+        });
+        for (auto& res : results) {
+            GEODE_UNWRAP(res);
+        }
         return Ok();
     }
 
     Result<> extractAllTo(Path const& dir) {
         GEODE_UNWRAP(file::createDirectoryAll(dir));
+        return this->extractEntries(dir, std::vector<bool>(m_entryOrder.size(), true));
+    }
 
-        GEODE_UNWRAP(
-            mzTry(mz_zip_goto_first_entry(m_handle))
-            .expect("Unable to navigate to first entry (code {error})")
-        );
+    Result<> extractChangedTo(Path const& dir) {
+        GEODE_UNWRAP(file::createDirectoryAll(dir));
 
-        uint64_t numEntries;
+        auto manifestPath = dir / EXTRACT_MANIFEST_NAME;
+        auto oldManifest = readExtractManifest(dir);
+
+        std::vector<bool> selected(m_entryOrder.size(), false);
+        matjson::Value manifest = matjson::Object();
+        for (size_t i = 0; i < m_entryOrder.size(); i++) {
+            auto const& name = m_entryOrder[i];
+            auto const& entry = m_entries.at(name);
+            if (entry.isDirectory) {
+                selected[i] = !ghc::filesystem::is_directory(dir / name);
+                continue;
+            }
+            auto key = name.string();
+            auto stamp = getEntryStamp(entry);
+            manifest[key] = stamp;
+
+            std::error_code ec;
+            auto size = ghc::filesystem::file_size(dir / name, ec);
+            selected[i] = ec ||
+                size != static_cast<uintmax_t>(entry.uncompressedSize) ||
+                !oldManifest.contains(key) ||
+                !oldManifest[key].is_string() ||
+                oldManifest[key].as_string() != stamp;
+        }
+
+        // remove files that are no longer in the zip
+        for (auto& [key, _] : oldManifest.as_object()) {
+            if (manifest.contains(key) || !isWithinDir(dir, key)) {
+                continue;
+            }
+            std::error_code ec;
+            ghc::filesystem::remove(dir / key, ec);
+        }
+
+        // if extraction is interrupted, the next one should not trust the 
+        // files on disk
+        std::error_code ec;
+        ghc::filesystem::remove(manifestPath, ec);
+
+        GEODE_UNWRAP(this->extractEntries(dir, selected));
 
         GEODE_UNWRAP(
-            mzTry(mz_zip_get_number_entry(m_handle, &numEntries))
-            .expect("Unable to get number of entries (code {error})")
+            file::writeString(manifestPath, manifest.dump(matjson::NO_INDENTATION))
+            .expect("Unable to write extraction manifest: {error}")
         );
+        return Ok();
+    }
 
-        uint32_t currentEntry = 0;
-        // while not at MZ_END_OF_LIST
-        do {
-            mz_zip_file* info = nullptr;
-            if (mz_zip_entry_get_info(m_handle, &info) != MZ_OK) {
-                return Err("Unable to get entry info");
-            }
-            currentEntry++;
-
-            Path filePath;
-            filePath.assign(info->filename, info->filename + info->filename_size);
+    Result<> updateDirectory(Path const& dir, Path const& root) {
+        auto staging = dir;
+        staging += ".staging";
+        auto previous = dir;
+        previous += ".old";
 
-            // make sure zip files like root/../../file.txt don't get extracted to 
-            // avoid zip attacks
-#ifdef GEODE_IS_WINDOWS
-            if (!std::filesystem::relative((dir / filePath).wstring(), dir.wstring()).empty()) {
-#else
-            if (!ghc::filesystem::relative(dir / filePath, dir).empty()) {
-#endif
-                if (m_entries.at(filePath).isDirectory) {
-                    GEODE_UNWRAP(file::createDirectoryAll(dir / filePath));
+        // leftovers from an update that was interrupted
+        std::error_code ec;
+        ghc::filesystem::remove_all(staging, ec);
+        ghc::filesystem::remove_all(previous, ec);
+        GEODE_UNWRAP(file::createDirectoryAll(staging));
+
+        auto oldManifest = readExtractManifest(dir);
+
+        std::vector<bool> selected(m_entryOrder.size(), false);
+        matjson::Value manifest = matjson::Object();
+        std::unordered_set<Path> createdDirs;
+        size_t reused = 0;
+        for (size_t i = 0; i < m_entryOrder.size(); i++) {
+            auto const& name = m_entryOrder[i];
+            auto rel = getPathInRoot(name, root);
+            if (!rel) {
+                continue;
+            }
+            auto const& entry = m_entries.at(name);
+            if (entry.isDirectory) {
+                selected[i] = true;
+                continue;
+            }
+            auto key = rel->string();
+            auto stamp = getEntryStamp(entry);
+            manifest[key] = stamp;
+
+            auto size = ghc::filesystem::file_size(dir / *rel, ec);
+            auto unchanged = !ec &&
+                size == static_cast<uintmax_t>(entry.uncompressedSize) &&
+                oldManifest.contains(key) &&
+                oldManifest[key].is_string() &&
+                oldManifest[key].as_string() == stamp;
+
+            if (unchanged && isWithinDir(staging, *rel)) {
+                auto target = staging / *rel;
+                if (createdDirs.insert(target.parent_path()).second) {
+                    GEODE_UNWRAP(file::createDirectoryAll(target.parent_path()));
                 }
-                else {
-                    GEODE_UNWRAP(this->extractAt(dir, filePath));
+                if (reuseFile(dir / *rel, target)) {
+                    reused += 1;
+                    continue;
                 }
-                m_progressCallback(currentEntry, numEntries);
-            }
-            else {
-                log::error(
-                    "Zip entry '{}' is not contained within zip bounds",
-                    dir / filePath
-                );
             }
-        } while (mz_zip_goto_next_entry(m_handle) == MZ_OK);
+            selected[i] = true;
+        }
+        log::debug("Reused {} unchanged files in {}", reused, dir);
+
+        GEODE_UNWRAP(this->extractEntries(staging, selected, root));
+        GEODE_UNWRAP(
+            file::writeString(staging / EXTRACT_MANIFEST_NAME, manifest.dump(matjson::NO_INDENTATION))
+            .expect("Unable to write extraction manifest: {error}")
+        );
 
+        // swap the staging directory in. if this is interrupted between the 
+        // renames, the directory is missing and the next update starts over
+        if (ghc::filesystem::exists(dir)) {
+            ghc::filesystem::rename(dir, previous, ec);
+            if (ec) {
+                return Err("Unable to move {} out of the way: {}", dir.string(), ec.message());
+            }
+        }
+        ghc::filesystem::rename(staging, dir, ec);
+        if (ec) {
+            std::error_code restoreEc;
+            ghc::filesystem::rename(previous, dir, restoreEc);
+            return Err("Unable to move {} into place: {}", staging.string(), ec.message());
+        }
+        ghc::filesystem::remove_all(previous, ec);
         return Ok();
     }
 
@@ -552,6 +876,14 @@ Result<> Unzip::extractAllTo(Path const& dir) {
     return m_impl->extractAllTo(dir);
 }
 
+Result<> Unzip::extractChangedTo(Path const& dir) {
+    return m_impl->extractChangedTo(dir);
+}
+
+Result<> Unzip::updateDirectory(Path const& dir, Path const& root) {
+    return m_impl->updateDirectory(dir, root);
+}
+
 Result<> Unzip::intoDir(
     Path const& from,
     Path const& to,
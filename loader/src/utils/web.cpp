@@ -1,9 +1,13 @@
 #include <Geode/cocos/platform/IncludeCurl.h>
 #include <Geode/loader/Loader.hpp>
 #include <Geode/utils/casts.hpp>
+#include <Geode/utils/string.hpp>
 #include <Geode/utils/web.hpp>
 #include <matjson.hpp>
-#include <thread>
+
+#include "ThreadPool.hpp"
+#include "WebCache.hpp"
+#include "WebClient.hpp"
 
 using namespace geode::prelude;
 using namespace web;
@@ -32,28 +36,25 @@ namespace geode::utils::fetch {
 Result<> web::fetchFile(
     std::string const& url, ghc::filesystem::path const& into, FileProgressCallback prog
 ) {
-    auto curl = curl_easy_init();
-
-    if (!curl) return Err("Curl not initialized!");
-
     std::ofstream file(into, std::ios::out | std::ios::binary);
 
     if (!file.is_open()) {
         return Err("Unable to open output file");
     }
 
+    auto curl = WebClient::get()->createHandle();
+
+    if (!curl) return Err("Curl not initialized!");
+
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &file);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeBinaryData);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
     if (prog) {
         curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
         curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, utils::fetch::progress);
         curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, &prog);
     }
-    auto res = curl_easy_perform(curl);
+    auto res = WebClient::get()->performSync(curl);
     if (res != CURLE_OK) {
         curl_easy_cleanup(curl);
         return Err("Fetch failed: " + std::string(curl_easy_strerror(res)));
@@ -70,18 +71,15 @@ Result<> web::fetchFile(
 }
 
 Result<ByteVector> web::fetchBytes(std::string const& url) {
-    auto curl = curl_easy_init();
+    auto curl = WebClient::get()->createHandle();
 
     if (!curl) return Err("Curl not initialized!");
 
     ByteVector ret;
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ret);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeBytes);
-    auto res = curl_easy_perform(curl);
+    auto res = WebClient::get()->performSync(curl);
     if (res != CURLE_OK) {
         curl_easy_cleanup(curl);
         return Err("Fetch failed");
@@ -109,18 +107,15 @@ Result<matjson::Value> web::fetchJSON(std::string const& url) {
 }
 
 Result<std::string> web::fetch(std::string const& url) {
-    auto curl = curl_easy_init();
+    auto curl = WebClient::get()->createHandle();
 
     if (!curl) return Err("Curl not initialized!");
 
     std::string ret;
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ret);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeString);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
-    auto res = curl_easy_perform(curl);
+    auto res = WebClient::get()->performSync(curl);
     if (res != CURLE_OK) {
         curl_easy_cleanup(curl);
         return Err("Fetch failed");
@@ -136,7 +131,7 @@ Result<std::string> web::fetch(std::string const& url) {
     return Err("Error getting info: " + std::string(curl_easy_strerror(res)));
 }
 
-class SentAsyncWebRequest::Impl {
+class SentAsyncWebRequest::Impl : public std::enable_shared_from_this<SentAsyncWebRequest::Impl> {
 private:
     enum class Status {
         Paused,
@@ -151,14 +146,15 @@ private:
     std::vector<AsyncExpectCode> m_expects;
     std::vector<AsyncProgress> m_progresses;
     std::vector<AsyncCancelled> m_cancelleds;
+    std::vector<AsyncReceived> m_receiveds;
     std::unordered_map<std::string, std::string> m_responseHeader;
     Status m_status = Status::Paused;
-    std::atomic<bool> m_paused = true;
     std::atomic<bool> m_cancelled = false;
     std::atomic<bool> m_finished = false;
     std::atomic<bool> m_cleanedUp = false;
-    std::condition_variable m_statusCV;
-    std::mutex m_statusMutex;
+    // set once the response has been handed to the last callback, after
+    // which nothing may join this request anymore. guarded by m_mutex
+    bool m_dataTaken = false;
     SentAsyncWebRequest* m_self;
 
     mutable std::mutex m_mutex;
@@ -170,14 +166,50 @@ private:
     bool m_sent = false;
     std::variant<std::monostate, std::ostream*, ghc::filesystem::path> m_target;
     std::vector<std::string> m_httpHeaders;
-
+    std::chrono::seconds m_timeoutSeconds;
+    CachePolicy m_cachePolicy;
+    // stored response for this request, if there is one
+    std::optional<WebCache::Entry> m_cached;
+    // set if the stored response couldn't be used after all
+    bool m_skipCache = false;
+
+    // resulting byte array
+    ByteVector m_data;
+    // output file if downloading to file
+    std::unique_ptr<std::ofstream> m_file = nullptr;
+
+    // the rest of the transfer state is only used on the network thread
+    CURL* m_curl = nullptr;
+    bool m_resume = false;
+    // size of the partially downloaded file when the transfer started
+    size_t m_resumeFrom = 0;
+    std::string m_range;
+    // whether the server sent the rest of the file instead of all of it
+    bool m_appending = false;
+    bool m_receiving = false;
+    // how much data has been passed to the received callbacks
+    size_t m_received = 0;
+
+    // latest progress from curl, picked up by the main thread once a frame
+    std::atomic<double> m_progressNow = 0;
+    std::atomic<double> m_progressTotal = 0;
+    std::atomic<bool> m_progressQueued = false;
+    // last progress handed to the main thread, only used on the network thread
+    double m_reportedNow = 0;
 
     template <class T>
     friend class AsyncWebResult;
     friend class AsyncWebRequest;
 
-    void pause();
-    void resume();
+    void start();
+    size_t receive(char const* data, size_t size);
+    bool beginBody(long code);
+    void notifyReceived(uint8_t const* data, size_t size);
+    void finish();
+    void finishFromCache(WebCache::Headers headers);
+    void reportProgress(double now, double total);
+    bool isCacheable() const;
+    WebCache::Headers getRequestHeaders() const;
     void error(std::string const& error, int code);
     void doCancel();
 
@@ -203,6 +235,8 @@ public:
     AsyncExpectCode m_expect = nullptr;
     AsyncProgress m_progress = nullptr;
     AsyncCancelled m_cancelled = nullptr;
+    AsyncReceived m_received = nullptr;
+    bool m_resume = false;
     std::string m_userAgent;
     std::string m_customRequest;
     bool m_isPostRequest = false;
@@ -211,7 +245,8 @@ public:
     bool m_sent = false;
     std::variant<std::monostate, std::ostream*, ghc::filesystem::path> m_target;
     std::vector<std::string> m_httpHeaders;
-    std::chrono::seconds m_timeoutSeconds;
+    std::chrono::seconds m_timeoutSeconds{0};
+    CachePolicy m_cachePolicy = CachePolicy::None;
 
     SentAsyncWebRequestHandle send(AsyncWebRequest&);
 };
@@ -230,199 +265,351 @@ SentAsyncWebRequest::Impl::Impl(SentAsyncWebRequest* self, AsyncWebRequest const
     m_postFields(req.m_impl->m_postFields),
     m_isJsonRequest(req.m_impl->m_isJsonRequest),
     m_sent(req.m_impl->m_sent),
-    m_httpHeaders(req.m_impl->m_httpHeaders) {
-
-#define AWAIT_RESUME()    \
-    {\
-        auto lock = std::unique_lock(m_statusMutex);\
-        m_statusCV.wait(lock, [this]() { \
-            return !m_paused; \
-        });\
-        if (m_cancelled) {\
-            this->doCancel();\
-            return;\
-        }\
-    }\
+    m_httpHeaders(req.m_impl->m_httpHeaders),
+    m_timeoutSeconds(req.m_impl->m_timeoutSeconds),
+    m_cachePolicy(req.m_impl->m_cachePolicy),
+    m_resume(req.m_impl->m_resume) {
 
     if (req.m_impl->m_then) m_thens.push_back(req.m_impl->m_then);
     if (req.m_impl->m_progress) m_progresses.push_back(req.m_impl->m_progress);
     if (req.m_impl->m_cancelled) m_cancelleds.push_back(req.m_impl->m_cancelled);
     if (req.m_impl->m_expect) m_expects.push_back(req.m_impl->m_expect);
+    if (req.m_impl->m_received) m_receiveds.push_back(req.m_impl->m_received);
+}
 
-    auto timeoutSeconds = req.m_impl->m_timeoutSeconds;
+bool SentAsyncWebRequest::Impl::isCacheable() const {
+    // only responses downloaded into memory are stored, files and streams
+    // are usually too large to be worth keeping a second copy of
+    return m_cachePolicy != CachePolicy::None &&
+        std::holds_alternative<std::monostate>(m_target) &&
+        !m_isPostRequest &&
+        (m_customRequest.empty() || m_customRequest == "GET");
+}
 
-    std::thread([this, timeoutSeconds]() {
-        thread::setName("Curl Request");
+WebCache::Headers SentAsyncWebRequest::Impl::getRequestHeaders() const {
+    WebCache::Headers headers;
+    for (auto& header : m_httpHeaders) {
+        auto colon = header.find(':');
+        if (colon == std::string::npos) continue;
+        headers[header.substr(0, colon)] = string::trim(header.substr(colon + 1));
+    }
+    if (m_userAgent.size()) {
+        headers["User-Agent"] = m_userAgent;
+    }
+    return headers;
+}
+
+void SentAsyncWebRequest::Impl::start() {
+    // this may be a retry, so start over
+    m_data.clear();
+    m_responseHeader.clear();
+    m_file = nullptr;
+    m_appending = false;
+    m_receiving = false;
+    m_received = 0;
+
+    if (!m_skipCache && this->isCacheable()) {
+        m_cached = WebCache::get()->find(m_url, this->getRequestHeaders());
+        if (m_cached && m_cachePolicy == CachePolicy::PreferCache && m_cached->isFresh()) {
+            ThreadPool::get()->push([this, self = shared_from_this()]() {
+                this->finishFromCache(m_cached->headers);
+            });
+            return;
+        }
+    }
 
-        AWAIT_RESUME();
+    auto curl = WebClient::get()->createHandle();
+    if (!curl) {
+        return this->error("Curl not initialized", -1);
+    }
 
-        auto curl = curl_easy_init();
-        if (!curl) {
-            return this->error("Curl not initialized", -1);
+    m_curl = curl;
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char* data, size_t size, size_t nmemb, void* ptr) {
+        return static_cast<SentAsyncWebRequest::Impl*>(ptr)->receive(data, size * nmemb);
+    });
+
+    // continue an earlier download into the same file
+    m_resumeFrom = 0;
+    if (m_resume && std::holds_alternative<ghc::filesystem::path>(m_target)) {
+        std::error_code ec;
+        auto size = ghc::filesystem::file_size(std::get<ghc::filesystem::path>(m_target), ec);
+        if (!ec && size > 0) {
+            m_resumeFrom = size;
+            // unlike RESUME_FROM, this doesn't fail the transfer if the
+            // server sends the whole file
+            m_range = fmt::format("{}-", m_resumeFrom);
+            curl_easy_setopt(curl, CURLOPT_RANGE, m_range.c_str());
         }
+    }
 
-        // resulting byte array
-        ByteVector ret;
-        // output file if downloading to file. unique_ptr because not always
-        // initialized but don't wanna manually managed memory
-        std::unique_ptr<std::ofstream> file = nullptr;
+    curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
+    // User Agent
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
 
-        // into file
-        if (std::holds_alternative<ghc::filesystem::path>(m_target)) {
-            file = std::make_unique<std::ofstream>(
-                std::get<ghc::filesystem::path>(m_target), std::ios::out | std::ios::binary
-            );
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, file.get());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeBinaryData);
+    // Headers
+    curl_slist* headers = nullptr;
+    for (auto& header : m_httpHeaders) {
+        headers = curl_slist_append(headers, header.c_str());
+    }
+    // ask the server to only send the response if the stored one is outdated
+    if (m_cached) {
+        if (auto etag = m_cached->getHeader("ETag")) {
+            headers = curl_slist_append(headers, ("If-None-Match: " + *etag).c_str());
         }
-        // into stream
-        else if (std::holds_alternative<std::ostream*>(m_target)) {
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, std::get<std::ostream*>(m_target));
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeBinaryData);
+        if (auto modified = m_cached->getHeader("Last-Modified")) {
+            headers = curl_slist_append(headers, ("If-Modified-Since: " + *modified).c_str());
         }
-        // into memory
-        else {
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &ret);
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, utils::fetch::writeBytes);
+    }
+
+    // Post request
+    if (m_isPostRequest || m_customRequest.size()) {
+        if (m_isPostRequest) {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
         }
-        curl_easy_setopt(curl, CURLOPT_URL, m_url.c_str());
-        // No need to verify SSL, we trust our domains :-)
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0);
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0);
-        // User Agent
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, m_userAgent.c_str());
-
-        // Headers
-        curl_slist* headers = nullptr;
-        for (auto& header : m_httpHeaders) {
-            headers = curl_slist_append(headers, header.c_str());
+        else {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, m_customRequest.c_str());
         }
-
-        // Post request
-        if (m_isPostRequest || m_customRequest.size()) {
-            if (m_isPostRequest) {
-                curl_easy_setopt(curl, CURLOPT_POST, 1L);
-            }
-            else {
-                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, m_customRequest.c_str());
-            }
-            if (m_isJsonRequest) {
-                headers = curl_slist_append(headers, "Content-Type: application/json");
-            }
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, m_postFields.c_str());
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, m_postFields.size());
+        if (m_isJsonRequest) {
+            headers = curl_slist_append(headers, "Content-Type: application/json");
         }
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, m_postFields.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, m_postFields.size());
+    }
 
-        // Timeout
-        if (timeoutSeconds.count()) {
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeoutSeconds.count());
-        }
+    // Timeout
+    if (m_timeoutSeconds.count()) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, m_timeoutSeconds.count());
+    }
 
-        // Track progress
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
-        // Follow redirects
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
-        // Fail if response code is 4XX or 5XX
-        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L); // we will handle http errors manually
-
-        // Headers end
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-
-        struct ProgressData {
-            SentAsyncWebRequest::Impl* self;
-            std::ofstream* file;
-        } data{this, file.get()};
-
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &data);
-        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (+[](char* buffer, size_t size, size_t nitems, void* ptr){
-            auto data = static_cast<ProgressData*>(ptr);
-            std::unordered_map<std::string, std::string> headers;
-            std::string line;
-            std::stringstream ss(std::string(buffer, size * nitems));
-            while (std::getline(ss, line)) {
-                auto colon = line.find(':');
-                if (colon == std::string::npos) continue;
-                auto key = line.substr(0, colon);
-                auto value = line.substr(colon + 2);
-                if (value.ends_with('\r')) {
-                    value = value.substr(0, value.size() - 1);
-                }
-                data->self->m_responseHeader[key] = value;
+    // Track progress
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
+    // Fail if response code is 4XX or 5XX
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L); // we will handle http errors manually
+
+    // Headers end
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (+[](char* buffer, size_t size, size_t nitems, void* ptr){
+        auto self = static_cast<SentAsyncWebRequest::Impl*>(ptr);
+        std::string line;
+        std::stringstream ss(std::string(buffer, size * nitems));
+        while (std::getline(ss, line)) {
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            auto key = line.substr(0, colon);
+            auto value = line.substr(colon + 2);
+            if (value.ends_with('\r')) {
+                value = value.substr(0, value.size() - 1);
             }
-            return size * nitems;
-        }));
-
-        curl_easy_setopt(
-            curl,
-            CURLOPT_PROGRESSFUNCTION,
-            +[](void* ptr, double total, double now, double, double) -> int {
-                auto data = static_cast<ProgressData*>(ptr);
-                auto lock = std::unique_lock(data->self->m_statusMutex);
-                data->self->m_statusCV.wait(lock, [data]() {
-                    return !data->self->m_paused;
-                });
-                if (data->self->m_cancelled) {
-                    if (data->file) {
-                        data->file->close();
-                    }
-                    return 1;
-                }
-
-                Loader::get()->queueInMainThread([self = data->self, now, total]() {
-                    std::unique_lock<std::mutex> l(self->m_mutex);
-                    for (auto& prog : self->m_progresses) {
-                        l.unlock();
-                        prog(*self->m_self, now, total);
-                        l.lock();
-                    }
-                });
-                return 0;
+            self->m_responseHeader[key] = value;
+        }
+        return size * nitems;
+    }));
+
+    // the progress function runs on the network thread, so it must never
+    // block since that would hold up every other request too
+    curl_easy_setopt(
+        curl,
+        CURLOPT_PROGRESSFUNCTION,
+        +[](void* ptr, double total, double now, double, double) -> int {
+            auto self = static_cast<SentAsyncWebRequest::Impl*>(ptr);
+            if (self->m_cancelled) {
+                return 1;
             }
-        );
-        curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, &data);
-        auto res = curl_easy_perform(curl);
+            self->reportProgress(now, total);
+            return 0;
+        }
+    );
+    curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, this);
 
+    WebClient::get()->perform(curl, [this, self = shared_from_this(), curl, headers](CURLcode res) {
         // free the header list
         curl_slist_free_all(headers);
 
         long code = 0;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+        curl_easy_cleanup(curl);
+        m_curl = nullptr;
+
+        // the file is still created if the response had no body
+        if (res == CURLE_OK && code < 400 && !m_receiving) {
+            m_receiving = true;
+            (void)this->beginBody(code);
+        }
+        // the file has to be complete before `then` and closed before it 
+        // can be removed when cancelling
+        if (m_file) {
+            m_file->close();
+        }
+
         if (res != CURLE_OK) {
-            curl_easy_cleanup(curl);
             if (m_cancelled) {
                 return this->doCancel();
             } else {
                 return this->error("Fetch failed: " + std::string(curl_easy_strerror(res)), code);
             }
         }
+        if (code == 304 && m_cached) {
+            // reading the stored body and saving the cache index would hold 
+            // up every other transfer on the network thread
+            ThreadPool::get()->push([this, self]() {
+                this->finishFromCache(WebCache::get()->refresh(*m_cached, m_responseHeader));
+            });
+            return;
+        }
+        if (code == 416 && m_resumeFrom > 0) {
+            // the partial file is longer than the file on the server, so it
+            // can't be a part of it
+            std::error_code ec;
+            ghc::filesystem::remove(std::get<ghc::filesystem::path>(m_target), ec);
+            return this->start();
+        }
         if (code >= 400 && code < 600) {
-            std::string response_str(ret.begin(), ret.end());
-            curl_easy_cleanup(curl);
+            std::string response_str(m_data.begin(), m_data.end());
             return this->error(response_str, code);
         }
-        curl_easy_cleanup(curl);
+        if (code == 200 && this->isCacheable()) {
+            WebCache::get()->store(
+                m_url, this->getRequestHeaders(), m_responseHeader,
+                std::string(m_data.begin(), m_data.end())
+            );
+        }
+        this->finish();
+    });
+}
+
+size_t SentAsyncWebRequest::Impl::receive(char const* data, size_t size) {
+    long code = 0;
+    curl_easy_getinfo(m_curl, CURLINFO_RESPONSE_CODE, &code);
+    // error responses are kept in memory to be reported, so they never end
+    // up in the file being downloaded into
+    if (code >= 400) {
+        m_data.insert(m_data.end(), data, data + size);
+        return size;
+    }
+    if (!m_receiving) {
+        m_receiving = true;
+        if (!this->beginBody(code)) {
+            // anything but the full size fails the transfer
+            return 0;
+        }
+    }
+
+    // into file
+    if (m_file) {
+        m_file->write(data, size);
+        if (!*m_file) {
+            return 0;
+        }
+    }
+    // into stream
+    else if (std::holds_alternative<std::ostream*>(m_target)) {
+        std::get<std::ostream*>(m_target)->write(data, size);
+    }
+    // into memory
+    else {
+        m_data.insert(m_data.end(), data, data + size);
+    }
+    this->notifyReceived(reinterpret_cast<uint8_t const*>(data), size);
+    return size;
+}
 
-        AWAIT_RESUME();
+bool SentAsyncWebRequest::Impl::beginBody(long code) {
+    if (!std::holds_alternative<ghc::filesystem::path>(m_target)) {
+        return true;
+    }
+    auto const& path = std::get<ghc::filesystem::path>(m_target);
 
-        // if something is still holding a handle to this
-        // request, then they may still cancel it
-        m_finished = true;
+    // the server may also ignore the range and send all of the file
+    m_appending = m_resumeFrom > 0 && code == 206;
 
-        Loader::get()->queueInMainThread([this, ret]() {
-            std::unique_lock<std::mutex> l(m_mutex);
-            for (auto& then : m_thens) {
-                l.unlock();
-                then(*m_self, ret);
-                l.lock();
+    // received callbacks get to see the whole file, including the part
+    // that was downloaded earlier
+    auto hasReceiveds = false;
+    {
+        std::lock_guard _(m_mutex);
+        hasReceiveds = !m_receiveds.empty();
+    }
+    if (m_appending && hasReceiveds) {
+        std::ifstream existing(path, std::ios::in | std::ios::binary);
+        std::vector<uint8_t> buffer(64 * 1024);
+        auto left = m_resumeFrom;
+        while (left > 0) {
+            existing.read(reinterpret_cast<char*>(buffer.data()), std::min(left, buffer.size()));
+            auto count = static_cast<size_t>(existing.gcount());
+            if (count == 0) {
+                return false;
             }
-            // Delay the destruction of SentAsyncWebRequest till the next frame
-            // otherwise we'd have an use-after-free
-            Loader::get()->queueInMainThread([m_id = m_id] {
-                std::lock_guard __(RUNNING_REQUESTS_MUTEX);
-                RUNNING_REQUESTS.erase(m_id);
-            });
+            this->notifyReceived(buffer.data(), count);
+            left -= count;
+        }
+    }
+
+    m_file = std::make_unique<std::ofstream>(
+        path, std::ios::out | std::ios::binary | (m_appending ? std::ios::app : std::ios::trunc)
+    );
+    return m_file->is_open();
+}
+
+void SentAsyncWebRequest::Impl::notifyReceived(uint8_t const* data, size_t size) {
+    std::lock_guard _(m_mutex);
+    for (auto& received : m_receiveds) {
+        received(data, size, m_received);
+    }
+    m_received += size;
+}
+
+void SentAsyncWebRequest::Impl::finishFromCache(WebCache::Headers headers) {
+    auto data = WebCache::get()->read(*m_cached);
+    if (!data) {
+        // the stored response is gone, so download it in full instead
+        log::warn("Unable to read cached response for {}: {}", m_url, data.unwrapErr());
+        WebCache::get()->remove(*m_cached);
+        m_cached = std::nullopt;
+        m_skipCache = true;
+        return this->start();
+    }
+    m_data = std::move(data.unwrap());
+    m_responseHeader = std::move(headers);
+    this->finish();
+}
+
+void SentAsyncWebRequest::Impl::finish() {
+    // if something is still holding a handle to this
+    // request, then they may still cancel it
+    m_finished = true;
+
+    Loader::get()->queueInMainThread([this, self = shared_from_this()]() {
+        std::unique_lock<std::mutex> l(m_mutex);
+        // callbacks may be joined while others run, so no iterators
+        for (size_t i = 0; i < m_thens.size(); i++) {
+            auto then = m_thens[i];
+            // only the last callback can take the data, the others
+            // each get their own copy. joining is closed off before the
+            // lock is released, so none can be added after it
+            ByteVector data;
+            if (i + 1 == m_thens.size()) {
+                data = std::move(m_data);
+                m_dataTaken = true;
+            }
+            else {
+                data = m_data;
+            }
+            l.unlock();
+            then(*m_self, std::move(data));
+            l.lock();
+        }
+        // callbacks joined from now on would never be called
+        m_dataTaken = true;
+        // Delay the destruction of SentAsyncWebRequest till the next frame
+        // otherwise we'd have an use-after-free
+        Loader::get()->queueInMainThread([m_id = m_id] {
+            std::lock_guard __(RUNNING_REQUESTS_MUTEX);
+            RUNNING_REQUESTS.erase(m_id);
         });
-    }).detach();
+    });
 }
 
 void SentAsyncWebRequest::Impl::doCancel() {
@@ -456,14 +643,52 @@ void SentAsyncWebRequest::Impl::cancel() {
     }
 }
 
-void SentAsyncWebRequest::Impl::pause() {
-    m_paused = true;
-    m_statusCV.notify_all();
-}
+void SentAsyncWebRequest::Impl::reportProgress(double now, double total) {
+    // curl only knows about the part of the file it's downloading
+    if (m_appending) {
+        now += m_resumeFrom;
+        if (total > 0) {
+            total += m_resumeFrom;
+        }
+    }
+
+    // curl calls this many times a second even if nothing was received, so
+    // only report once the download has moved by at least a percent (or a
+    // chunk if the size is unknown) or has finished
+    auto finished = total > 0 && now >= total;
+    auto step = total > 0 ? total / 100 : 64.0 * 1024;
+    if (now == m_reportedNow || (!finished && now - m_reportedNow < step)) {
+        return;
+    }
+    m_reportedNow = now;
+    m_progressNow = now;
+    m_progressTotal = total;
+
+    // at most one update per request is waiting for the main thread at a
+    // time, which picks up whatever the latest progress is by then
+    if (m_progressQueued.exchange(true)) {
+        return;
+    }
+    // progress is superseded by the next update anyway, so it can wait for 
+    // frames that have time to spare
+    Loader::get()->queueInMainThread([self = shared_from_this()]() {
+        self->m_progressQueued = false;
+        // the request may have finished while this was waiting, in which 
+        // case its callbacks already ran
+        if (self->m_finished) {
+            return;
+        }
+        auto now = self->m_progressNow.load();
+        auto total = self->m_progressTotal.load();
 
-void SentAsyncWebRequest::Impl::resume() {
-    m_paused = false;
-    m_statusCV.notify_all();
+        std::unique_lock<std::mutex> l(self->m_mutex);
+        for (size_t i = 0; i < self->m_progresses.size(); i++) {
+            auto prog = self->m_progresses[i];
+            l.unlock();
+            prog(*self->m_self, now, total);
+            l.lock();
+        }
+    }, Loader::TaskPriority::Background);
 }
 
 bool SentAsyncWebRequest::Impl::finished() const {
@@ -471,10 +696,6 @@ bool SentAsyncWebRequest::Impl::finished() const {
 }
 
 void SentAsyncWebRequest::Impl::error(std::string const& error, int code) {
-    auto lock = std::unique_lock(m_statusMutex);
-    m_statusCV.wait(lock, [this]() {
-        return !m_paused;
-    });
     Loader::get()->queueInMainThread([this, error, code]() {
         {
             std::unique_lock<std::mutex> l(m_mutex);
@@ -495,6 +716,7 @@ SentAsyncWebRequest::~SentAsyncWebRequest() {}
 std::shared_ptr<SentAsyncWebRequest> SentAsyncWebRequest::create(AsyncWebRequest const& request, std::string const& id) {
     auto ret = std::make_shared<SentAsyncWebRequest>();
     ret->m_impl = std::move(std::make_shared<SentAsyncWebRequest::Impl>(ret.get(), request, id));
+    ret->m_impl->start();
     return ret;
 }
 std::string SentAsyncWebRequest::getResponseHeader(std::string_view header) const {
@@ -509,14 +731,6 @@ void SentAsyncWebRequest::cancel() {
     return m_impl->cancel();
 }
 
-void SentAsyncWebRequest::pause() {
-    return m_impl->pause();
-}
-
-void SentAsyncWebRequest::resume() {
-    return m_impl->resume();
-}
-
 bool SentAsyncWebRequest::finished() const {
     return m_impl->finished();
 }
@@ -577,6 +791,11 @@ AsyncWebRequest& AsyncWebRequest::timeout(std::chrono::seconds seconds) {
     return *this;
 }
 
+AsyncWebRequest& AsyncWebRequest::cache(CachePolicy policy) {
+    m_impl->m_cachePolicy = policy;
+    return *this;
+}
+
 AsyncWebRequest& AsyncWebRequest::header(std::string_view const header) {
     std::string str(header);
     // remove \r and \n
@@ -638,6 +857,11 @@ AsyncWebRequest& AsyncWebRequest::cancelled(AsyncCancelled cancelledFunc) {
     return *this;
 }
 
+AsyncWebRequest& AsyncWebRequest::received(AsyncReceived handler) {
+    m_impl->m_received = handler;
+    return *this;
+}
+
 SentAsyncWebRequestHandle AsyncWebRequest::send() {
     return m_impl->send(*this);
 }
@@ -648,33 +872,32 @@ SentAsyncWebRequestHandle AsyncWebRequest::Impl::send(AsyncWebRequest& reqObj) {
 
     std::lock_guard __(RUNNING_REQUESTS_MUTEX);
 
-    // pause all running requests
-    for (auto& [_, req] : RUNNING_REQUESTS) {
-        req->pause();
-    }
-
     SentAsyncWebRequestHandle ret;
 
     static size_t COUNTER = 0;
     if (m_joinID && RUNNING_REQUESTS.count(m_joinID.value())) {
         auto& req = RUNNING_REQUESTS.at(m_joinID.value());
+        // the request's callbacks only ever run with its own lock, so the
+        // new ones are picked up without holding up the transfer
         std::lock_guard _(req->m_impl->m_mutex);
-        if (m_then) req->m_impl->m_thens.push_back(m_then);
-        if (m_progress) req->m_impl->m_progresses.push_back(m_progress);
-        if (m_expect) req->m_impl->m_expects.push_back(m_expect);
-        if (m_cancelled) req->m_impl->m_cancelleds.push_back(m_cancelled);
-        ret = req;
-    }
-    else {
-        auto id = m_joinID.value_or("__anon_request_" + std::to_string(COUNTER++));
-        ret = SentAsyncWebRequest::create(reqObj, id);
-        RUNNING_REQUESTS.insert({id, ret});
+        // a request that already handed out its response has nothing left
+        // to give, so this one has to be sent on its own
+        if (!req->m_impl->m_dataTaken) {
+            if (m_then) req->m_impl->m_thens.push_back(m_then);
+            if (m_progress) req->m_impl->m_progresses.push_back(m_progress);
+            if (m_expect) req->m_impl->m_expects.push_back(m_expect);
+            if (m_cancelled) req->m_impl->m_cancelleds.push_back(m_cancelled);
+            if (m_received) req->m_impl->m_receiveds.push_back(m_received);
+            return req;
+        }
     }
 
-    // resume all running requests
-    for (auto& [_, req] : RUNNING_REQUESTS) {
-        req->resume();
-    }
+    // the finished request keeps the join ID until it's cleaned up
+    auto id = m_joinID && !RUNNING_REQUESTS.count(m_joinID.value()) ?
+        m_joinID.value() :
+        "__anon_request_" + std::to_string(COUNTER++);
+    ret = SentAsyncWebRequest::create(reqObj, id);
+    RUNNING_REQUESTS.insert({id, ret});
 
     return ret;
 }
@@ -693,6 +916,11 @@ AsyncWebResult<std::monostate> AsyncWebResponse::into(ghc::filesystem::path cons
     });
 }
 
+AsyncWebResult<std::monostate> AsyncWebResponse::resumeInto(ghc::filesystem::path const& path) {
+    m_request.m_impl->m_resume = true;
+    return this->into(path);
+}
+
 AsyncWebResult<std::string> AsyncWebResponse::text() {
     return this->as(+[](ByteVector const& bytes) -> Result<std::string> {
         return Ok(std::string(bytes.begin(), bytes.end()));
@@ -700,8 +928,8 @@ AsyncWebResult<std::string> AsyncWebResponse::text() {
 }
 
 AsyncWebResult<ByteVector> AsyncWebResponse::bytes() {
-    return this->as(+[](ByteVector const& bytes) -> Result<ByteVector> {
-        return Ok(bytes);
+    return AsyncWebResult<ByteVector>(m_request, +[](ByteVector&& bytes) -> Result<ByteVector> {
+        return Ok(std::move(bytes));
     });
 }
 
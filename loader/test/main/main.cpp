@@ -13,6 +13,25 @@ auto test = []() {
 // Exported functions
 $on_mod(Loaded) {
     log::info("Loaded");
+
+    // Binary saved values. Saving before anything has read them must keep 
+    // the values written on the previous launch
+    auto mod = Mod::get();
+    if (mod->getSavedValueFormat() == SavedValueFormat::Binary) {
+        (void)mod->saveData();
+        auto launches = mod->getSavedValue<int64_t>("binary-launches", 0);
+        if (launches > 0) {
+            log::info("Binary saved values survived an untouched save ({} launches)", launches);
+        }
+        else {
+            log::error("Binary saved values were lost by an untouched save");
+        }
+        mod->setSavedValue("binary-launches", launches + 1);
+    }
+    else {
+        mod->setSavedValueFormat(SavedValueFormat::Binary);
+        mod->setSavedValue<int64_t>("binary-launches", 1);
+    }
 }
 
 static std::string s_recievedEvent;
@@ -0,0 +1,230 @@
+#include "BinaryLogFormat.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include <zlib.h>
+
+using namespace geode::log;
+
+namespace {
+    struct Filter {
+        uint8_t minSeverity = 0;
+        std::unordered_set<std::string> sources;
+        std::unordered_set<std::string> threads;
+        std::string contains;
+    };
+
+    class Reader {
+        gzFile m_file;
+
+    public:
+        explicit Reader(gzFile file) : m_file(file) {}
+
+        bool read(void* out, size_t size) {
+            return size == 0 || gzread(m_file, out, static_cast<unsigned>(size)) == static_cast<int>(size);
+        }
+
+        template <class T>
+        bool read(T& out) {
+            return this->read(&out, sizeof(T));
+        }
+
+        bool readString(std::string& out, size_t size) {
+            out.resize(size);
+            return this->read(out.data(), size);
+        }
+    };
+
+    std::optional<uint8_t> parseSeverity(std::string_view level) {
+        if (level == "debug") return 0;
+        if (level == "info") return 1;
+        if (level == "warn" || level == "warning") return 2;
+        if (level == "error") return 3;
+        return std::nullopt;
+    }
+
+    char const* severityName(uint8_t severity) {
+        switch (severity) {
+            case 0: return "DEBUG";
+            case 1: return "INFO ";
+            case 2: return "WARN ";
+            case 3: return "ERROR";
+            default: return "?????";
+        }
+    }
+
+    void printLog(uint64_t time, std::string const& thread, std::string const& source, uint8_t severity, std::string const& content) {
+        auto seconds = static_cast<std::time_t>(time / 1000000);
+        auto millis = static_cast<unsigned>(time / 1000 % 1000);
+        char timeStr[32] = "?";
+        if (auto tm = std::localtime(&seconds)) {
+            std::strftime(timeStr, sizeof(timeStr), "%F %H:%M:%S", tm);
+        }
+        if (thread.empty()) {
+            std::printf("%s.%03u %s [%s]: %s\n", timeStr, millis, severityName(severity), source.c_str(), content.c_str());
+        }
+        else {
+            std::printf("%s.%03u %s [%s] [%s]: %s\n", timeStr, millis, severityName(severity), thread.c_str(), source.c_str(), content.c_str());
+        }
+    }
+
+    bool decode(char const* path, Filter const& filter) {
+        auto file = gzopen(path, "rb");
+        if (!file) {
+            std::fprintf(stderr, "%s: unable to open file\n", path);
+            return false;
+        }
+        Reader reader(file);
+
+        char magic[sizeof(binary::MAGIC)];
+        uint16_t version, reserved;
+        if (!reader.read(magic) || std::memcmp(magic, binary::MAGIC, sizeof(magic)) != 0 ||
+            !reader.read(version) || !reader.read(reserved)) {
+            std::fprintf(stderr, "%s: not a binary log\n", path);
+            gzclose(file);
+            return false;
+        }
+        if (version > binary::VERSION) {
+            std::fprintf(stderr, "%s: unsupported version %u\n", path, version);
+            gzclose(file);
+            return false;
+        }
+
+        std::vector<std::string> sources;
+        std::vector<std::string> threads;
+        std::string content;
+        bool ok = true;
+        uint8_t type;
+        while (reader.read(type)) {
+            switch (static_cast<binary::RecordType>(type)) {
+                case binary::RecordType::Source:
+                case binary::RecordType::Thread: {
+                    auto& names = type == static_cast<uint8_t>(binary::RecordType::Source) ? sources : threads;
+                    uint16_t index, length;
+                    std::string name;
+                    if (!reader.read(index) || !reader.read(length) || !reader.readString(name, length)) {
+                        ok = false;
+                        break;
+                    }
+                    if (names.size() <= index) {
+                        names.resize(index + 1);
+                    }
+                    names[index] = std::move(name);
+                } break;
+
+                case binary::RecordType::Log: {
+                    uint64_t time;
+                    uint16_t thread, source;
+                    uint8_t severity;
+                    uint32_t length;
+                    if (
+                        !reader.read(time) || !reader.read(thread) || !reader.read(source) ||
+                        !reader.read(severity) || !reader.read(length) || !reader.readString(content, length) ||
+                        thread >= threads.size() || source >= sources.size()
+                    ) {
+                        ok = false;
+                        break;
+                    }
+                    if (
+                        severity < filter.minSeverity ||
+                        (!filter.sources.empty() && !filter.sources.contains(sources[source])) ||
+                        (!filter.threads.empty() && !filter.threads.contains(threads[thread])) ||
+                        (!filter.contains.empty() && content.find(filter.contains) == std::string::npos)
+                    ) {
+                        break;
+                    }
+                    printLog(time, threads[thread], sources[source], severity, content);
+                } break;
+
+                default: {
+                    ok = false;
+                } break;
+            }
+            if (!ok) {
+                break;
+            }
+        }
+        gzclose(file);
+
+        // the last record of a segment that was being written when the game
+        // closed may be cut off
+        if (!ok) {
+            std::fprintf(stderr, "%s: log is truncated or corrupted\n", path);
+        }
+        return ok;
+    }
+
+    void printUsage(char const* name) {
+        std::fprintf(
+            stderr,
+            "Usage: %s [options] <segment>...\n"
+            "Decodes Geode binary log segments (.glog or .glog.gz) in the given order\n"
+            "\n"
+            "Options:\n"
+            "  --level <level>    Only show logs of at least this severity\n"
+            "                     (debug, info, warning, error)\n"
+            "  --source <name>    Only show logs from this source, can be repeated\n"
+            "  --thread <name>    Only show logs from this thread, can be repeated\n"
+            "  --contains <text>  Only show logs containing this text\n",
+            name
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    Filter filter;
+    std::vector<char const*> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (arg.starts_with("--")) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--level") {
+                auto severity = parseSeverity(value);
+                if (!severity) {
+                    std::fprintf(stderr, "Unknown level %s\n", value.c_str());
+                    return 1;
+                }
+                filter.minSeverity = *severity;
+            }
+            else if (arg == "--source") {
+                filter.sources.insert(value);
+            }
+            else if (arg == "--thread") {
+                filter.threads.insert(value);
+            }
+            else if (arg == "--contains") {
+                filter.contains = value;
+            }
+            else {
+                std::fprintf(stderr, "Unknown option %s\n", argv[i - 1]);
+                return 1;
+            }
+            continue;
+        }
+        paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    for (auto path : paths) {
+        ok = decode(path, filter) && ok;
+    }
+    return ok ? 0 : 1;
+}